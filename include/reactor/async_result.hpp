@@ -0,0 +1,118 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_ASYNC_RESULT_HPP__
+#define __IWS_REACTOR_ASYNC_RESULT_HPP__
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define REACTOR_HAS_COROUTINES 1
+#endif
+#endif
+
+namespace iws {
+namespace reactor {
+
+namespace detail {
+
+/**
+ * @brief Completion state shared by an async_result and the task producing it
+ */
+class async_state
+{
+ public:
+   async_state();
+
+   /**
+    * @brief store the outcome, wake the waiters and run the continuations on the calling thread
+    */
+   void complete(void *obj, std::exception_ptr error);
+   /**
+    * @brief run a function once completed
+    * @return false if already completed, the function is not called then
+    */
+   bool add_continuation(std::function<void()> continuation);
+
+   bool is_ready() const;
+   void wait() const;
+   /**
+    * @brief wait for the object, rethrows the exception of the construction
+    */
+   void *get() const;
+
+ private:
+   mutable std::mutex _mutex;
+   mutable std::condition_variable _cv;
+   bool _done;
+   void *_obj;
+   std::exception_ptr _error;
+   std::vector<std::function<void()>> _continuations;
+};
+
+} // namespace detail
+
+/**
+ * @brief Result of reactor::get_async(), like a shared_future of a reference
+ *
+ * Copies share the same state. In C++20 builds it can also be co_await-ed, the coroutine is resumed on the thread that
+ * completed the construction (or right away if the object was ready).
+ */
+template<typename T>
+class async_result
+{
+ public:
+   explicit async_result(const std::shared_ptr<detail::async_state> &state);
+
+   bool is_ready() const { return _state->is_ready(); }
+   void wait() const { _state->wait(); }
+   /**
+    * @brief wait for the object
+    * @throws the exception thrown by the construction
+    */
+   T &get() const { return *static_cast<T *>(_state->get()); }
+
+#ifdef REACTOR_HAS_COROUTINES
+   bool await_ready() const { return _state->is_ready(); }
+   bool await_suspend(std::coroutine_handle<> handle) const
+   {
+      return _state->add_continuation([handle]() { handle.resume(); });
+   }
+   T &await_resume() const { return get(); }
+#endif
+
+ private:
+   std::shared_ptr<detail::async_state> _state;
+};
+
+// ----
+
+template<typename T>
+async_result<T>::async_result(const std::shared_ptr<detail::async_state> &state)
+      : _state(state)
+{
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_ASYNC_RESULT_HPP__
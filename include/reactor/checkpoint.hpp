@@ -0,0 +1,67 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_CHECKPOINT_HPP__
+#define __IWS_REACTOR_CHECKPOINT_HPP__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "factory_base.hpp"
+#include "index.hpp"
+
+namespace iws {
+namespace reactor {
+
+class reactor;
+
+/**
+ * @brief The objects of a reactor existing at a point in time, see reactor::checkpoint()
+ *
+ * Holds the objects weakly together with the factory they would be selected from at the time, so keeping a checkpoint
+ * doesn't keep any object alive.
+ */
+class object_checkpoint
+{
+ public:
+   object_checkpoint()
+         : _owner(nullptr)
+   {
+   }
+
+   /**
+    * @brief number of objects recorded
+    */
+   size_t size() const { return _entries.size(); }
+
+ private:
+   struct entry
+   {
+      index id;
+      std::weak_ptr<void> object;
+      std::shared_ptr<factory_base> factory;
+   };
+
+   const reactor *_owner;
+   std::vector<entry> _entries; // In creation order
+
+   friend class reactor;
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_CHECKPOINT_HPP__
@@ -27,8 +27,8 @@ template<typename T>
 class contract : public typed_contract<T>
 {
  public:
-   contract(const std::string &instance = std::string());
-   contract(reactor *r_inst, const std::string &instance = std::string());
+   contract(pf::string_view instance = pf::string_view());
+   contract(reactor *r_inst, pf::string_view instance = pf::string_view());
    virtual ~contract();
    virtual const index &get_index() const override;
    virtual void try_get() override;
@@ -40,14 +40,14 @@ class contract : public typed_contract<T>
 // ----
 
 template<typename T>
-contract<T>::contract(const std::string &instance)
+contract<T>::contract(pf::string_view instance)
       : typed_contract<T>()
       , _index(typeid(T), instance)
 {
 }
 
 template<typename T>
-contract<T>::contract(reactor *r_inst, const std::string &instance)
+contract<T>::contract(reactor *r_inst, pf::string_view instance)
       : typed_contract<T>(r_inst)
       , _index(typeid(T), instance)
 {
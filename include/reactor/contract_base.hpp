@@ -16,6 +16,7 @@
 #define __IWS_REACTOR_CONTRACT_BASE_HPP__
 
 #include "index.hpp"
+#include "object_slot.hpp"
 
 namespace iws {
 namespace reactor {
@@ -31,8 +32,16 @@ class contract_base
    virtual const index &get_index() const = 0;
    virtual void try_get() = 0;
 
+   /**
+    * @brief object last resolved through this contract, used by reactor::get() to skip the lookup
+    */
+   object_slot &get_slot() const { return _slot; }
+
  protected:
    reactor *const _r_inst;
+
+ private:
+   mutable object_slot _slot;
 };
 
 } // namespace reactor
@@ -0,0 +1,99 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_DEPENDENCY_GRAPH_HPP__
+#define __IWS_REACTOR_DEPENDENCY_GRAPH_HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "flat_map.hpp"
+#include "index.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Objects constructed by a reactor and the objects their constructors got
+ *
+ * Recorded while the objects are constructed (see reactor::get_dependency_graph()), so it only holds what actually
+ * happened since the last reset_objects().
+ */
+class dependency_graph
+{
+ public:
+   struct node
+   {
+      explicit node(const index &node_id);
+
+      index id;
+      std::chrono::nanoseconds construction_time; // Includes the dependencies constructed by the constructor
+      std::vector<index> dependencies;             // In order of the first get() call
+   };
+   typedef std::vector<node> node_list;
+
+   /**
+    * @brief the nodes in the order they were first seen
+    */
+   const node_list &nodes() const { return _nodes; }
+   /**
+    * @brief find the node of an index
+    * @return nullptr if the index was never constructed or used as a dependency
+    */
+   const node *find(const index &id) const;
+   bool empty() const { return _nodes.empty(); }
+
+   /**
+    * @brief Graphviz representation, edges point from the dependent object to its dependency
+    */
+   std::string to_dot() const;
+   /**
+    * @brief JSON representation: {"nodes":[{"type":..,"instance":..,"construction_time_ns":..,"dependencies":[..]}]}
+    *
+    * Dependencies are referenced with their position in the nodes array.
+    */
+   std::string to_json() const;
+
+   /**
+    * @brief the index and everything depending on it directly or transitively, in no particular order
+    */
+   std::vector<index> collect_dependents(const index &id) const;
+   /**
+    * @brief the indexes and everything depending on any of them, each listed once, in a single traversal
+    */
+   std::vector<index> collect_dependents(const std::vector<index> &ids) const;
+
+   void add_dependency(const index &dependent, const index &dependency);
+   void set_construction_time(const index &id, std::chrono::nanoseconds time);
+   /**
+    * @brief remove nodes together with the edges pointing to them, in a single pass over the graph
+    */
+   void remove(const std::vector<index> &ids);
+   void clear();
+
+ private:
+   node &get_node(const index &id);
+
+   node_list _nodes;
+   flat_map<index, size_t> _positions;             // Position of the node in _nodes
+   flat_map<index, std::vector<index>> _dependents; // Reverse edges, the nodes whose constructor got the key
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_DEPENDENCY_GRAPH_HPP__
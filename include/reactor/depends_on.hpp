@@ -0,0 +1,84 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_DEPENDS_ON_HPP__
+#define __IWS_REACTOR_DEPENDS_ON_HPP__
+
+#include <typeindex>
+
+#include "factory_base.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief declares the interfaces an object needs, so the reactor can plan the construction without running it
+ *
+ * Either pass it to a registrator as the first argument:
+ *    factory_registrator<i_example, example_impl> registrator(depends_on<i_log, i_config>(), prio_normal);
+ * or declare it in the constructed type, the factory picks it up by itself:
+ *    typedef depends_on<i_log, i_config> dependencies;
+ * Dependencies refer to the default instances of the given types.
+ */
+template<typename... D>
+struct depends_on
+{
+   static factory_base::dependency_list types() { return factory_base::dependency_list{std::type_index(typeid(D))...}; }
+};
+
+namespace detail {
+
+template<typename... Ts>
+struct make_void
+{
+   typedef void type;
+};
+
+/**
+ * @brief the dependencies declared by T::dependencies, none if T has no such member
+ */
+template<typename T, typename = void>
+struct declared_dependencies
+{
+   static factory_base::dependency_list types() { return factory_base::dependency_list(); }
+};
+
+template<typename T>
+struct declared_dependencies<T, typename make_void<typename T::dependencies>::type>
+{
+   static factory_base::dependency_list types() { return T::dependencies::types(); }
+};
+
+/**
+ * @brief true if T declares static const bool construct_lazily = true (see factory_base::set_lazy())
+ */
+template<typename T, typename = void>
+struct declared_lazy
+{
+   static bool value() { return false; }
+};
+
+template<typename T>
+struct declared_lazy<T, typename make_void<decltype(T::construct_lazily)>::type>
+{
+   static bool value() { return T::construct_lazily; }
+};
+
+} // namespace detail
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_DEPENDS_ON_HPP__
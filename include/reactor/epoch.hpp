@@ -0,0 +1,171 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_EPOCH_HPP__
+#define __IWS_REACTOR_EPOCH_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ThreadSanitizer can't model standalone fences (and gcc refuses to build them with -Wtsan), see epoch_domain::enter()
+#if defined(__SANITIZE_THREAD__)
+#define REACTOR_EPOCH_TSAN
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define REACTOR_EPOCH_TSAN
+#endif
+#endif
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Epoch based reclamation for the lock-free read paths of reactor
+ *
+ * Readers mark themselves active in a per thread record, so entering and leaving a read section never writes a cache
+ * line shared with other threads. Writers replace a shared structure, then retire the old one; it is only deleted
+ * after every reader that might still see it has left its read section.
+ */
+class epoch_domain
+{
+ public:
+   typedef void (*deleter)(void *);
+
+   struct participant
+   {
+      std::atomic<uint64_t> epoch; // 0 while the owner thread is outside of any read section
+      unsigned depth;              // Only touched by the owner thread
+      std::atomic<bool> in_use;
+      participant *next;
+      char padding[64]; // Keep the hot epoch of different threads on different cache lines
+   };
+
+   /**
+    * @brief get the process wide domain
+    *
+    * Never destructed, so read sections are usable in the static init and deinit phases.
+    */
+   static epoch_domain &instance();
+
+   /**
+    * @brief enter a read section on the calling thread (can be nested)
+    */
+   void enter();
+   /**
+    * @brief leave the read section entered by the matching enter()
+    */
+   void leave();
+
+   /**
+    * @brief schedule an object for deletion once no reader can see it anymore
+    *
+    * The caller must have already made the object unreachable for new readers.
+    */
+   void retire(void *ptr, deleter del);
+
+   /**
+    * @brief wait until every read section entered before this call has been left
+    *
+    * Read sections of the calling thread are not waited for, they could never be left.
+    */
+   void synchronize();
+
+ private:
+   struct retired
+   {
+      uint64_t epoch;
+      void *ptr;
+      deleter del;
+   };
+
+   epoch_domain();
+   epoch_domain(const epoch_domain &) = delete;
+   epoch_domain &operator=(const epoch_domain &) = delete;
+
+   participant &local();
+   participant &acquire_participant();
+   void release_participant(participant &p);
+   uint64_t min_active_epoch();
+
+   std::atomic<uint64_t> _global_epoch;
+   std::atomic<participant *> _participants;
+   std::mutex _retired_mutex;
+   std::vector<retired> _retired;
+
+   friend struct participant_releaser;
+};
+
+/**
+ * @brief RAII read section of an epoch_domain
+ */
+class epoch_guard
+{
+ public:
+   explicit epoch_guard(epoch_domain &domain = epoch_domain::instance())
+         : _domain(domain)
+   {
+      _domain.enter();
+   }
+   ~epoch_guard() { _domain.leave(); }
+
+   epoch_guard(const epoch_guard &) = delete;
+   epoch_guard &operator=(const epoch_guard &) = delete;
+
+ private:
+   epoch_domain &_domain;
+};
+
+// ----
+
+inline epoch_domain::participant &epoch_domain::local()
+{
+   static thread_local participant *p = nullptr;
+   if (nullptr == p)
+   {
+      p = &acquire_participant();
+   }
+   return *p;
+}
+
+inline void epoch_domain::enter()
+{
+   participant &p = local();
+   if (0 == p.depth++)
+   {
+      p.epoch.store(_global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+      // Pairs with the writers scanning the participants: either the writer sees us active, or we see its new pointer
+#ifdef REACTOR_EPOCH_TSAN
+      // Same guarantee through the writers' increments of the global epoch, at the cost of sharing its cache line
+      _global_epoch.fetch_add(0, std::memory_order_acq_rel);
+#else
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+   }
+}
+
+inline void epoch_domain::leave()
+{
+   participant &p = local();
+   if (0 == --p.depth)
+   {
+      p.epoch.store(0, std::memory_order_release);
+   }
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_EPOCH_HPP__
@@ -15,6 +15,7 @@
 #ifndef __IWS_REACTOR_FACTORY_HPP__
 #define __IWS_REACTOR_FACTORY_HPP__
 
+#include "depends_on.hpp"
 #include "factory_base.hpp"
 
 #include "integer_sequence_polyfil.hpp"
@@ -31,6 +32,8 @@ namespace pf = ::iws::polyfil;
  * This factory can construct any type, and return it downcasted as it's base class (preferably interface).
  * It holds the given constructor arguments, and passes them to the constructor of the given type.
  * It can also pass an instance name to the constructor as the first parameter.
+ * The dependencies declared by T::dependencies (see depends_on) are declared for the factory, and it is lazy if T
+ * declares static const bool construct_lazily = true (see factory_base::set_lazy()).
  *
  * @tparam I The returned type (preferably an interface class).
  * @tparam T The constructed type.
@@ -71,6 +74,8 @@ factory<I, T, pass_name, Args...>::factory(Args &&...args)
       : factory_base(typeid(I))
       , _args(std::forward<Args>(args)...)
 {
+   set_dependencies(detail::declared_dependencies<T>::types());
+   set_lazy(detail::declared_lazy<T>::value());
 }
 
 template<typename I, typename T, bool pass_name, typename... Args>
@@ -16,7 +16,9 @@
 #define __IWS_REACTOR_FACTORY_BASE_HPP__
 
 #include <string>
+#include <typeindex>
 #include <typeinfo>
+#include <vector>
 
 #include "factory_result.hpp"
 
@@ -32,6 +34,8 @@ namespace reactor {
 class factory_base
 {
  public:
+   typedef std::vector<std::type_index> dependency_list;
+
    /**
     * @brief factory_base constructor
     * @param type is the type_info of which type of objects the factory will produce.
@@ -50,8 +54,32 @@ class factory_base
     */
    virtual factory_result produce(const std::string &instance) const = 0;
 
+   /**
+    * @brief get the declared dependencies
+    * @return the types whose default instances the produced object needs (see depends_on)
+    */
+   const dependency_list &get_dependencies() const;
+   /**
+    * @brief declare the dependencies, must be called before the factory is registered
+    */
+   void set_dependencies(const dependency_list &dependencies);
+
+   /**
+    * @brief tell if the produced object is only constructed on its first use
+    */
+   bool is_lazy() const;
+   /**
+    * @brief construct the produced object on its first use only, must be called before the factory is registered
+    *
+    * A reference_pulley of a lazy factory resolves on its first access instead of its construction, and
+    * reactor::instantiate_all() leaves the object out. A get() still constructs it right away.
+    */
+   void set_lazy(bool lazy);
+
  private:
    const std::type_info &_type;
+   dependency_list _dependencies;
+   bool _lazy;
 };
 
 } // namespace reactor
@@ -17,6 +17,7 @@
 
 #include <string>
 
+#include "depends_on.hpp"
 #include "factory.hpp"
 #include "priorities.hpp"
 #include "r.hpp"
@@ -62,11 +63,27 @@ class factory_registrator
    template<typename... Args>
    factory_registrator(const std::string &instance, priorities priority, Args &&...args);
 
+   /**
+    * @brief factory_registrator default instance constructor with declared dependencies
+    * @param dependencies replaces the ones declared by T::dependencies
+    */
+   template<typename... D, typename... Args>
+   factory_registrator(depends_on<D...> dependencies, priorities priority, Args &&...args);
+
+   /**
+    * @brief factory_registrator instance specific constructor with declared dependencies
+    * @param dependencies replaces the ones declared by T::dependencies
+    */
+   template<typename... D, typename... Args>
+   factory_registrator(
+         depends_on<D...> dependencies, const std::string &instance, priorities priority, Args &&...args);
+
    ~factory_registrator();
 
  private:
    const std::string _name;
    const priorities _priority;
+   const std::shared_ptr<factory_base> _factory; // Only this one is unregistered, not a factory it lost against
 };
 
 // ----
@@ -76,9 +93,9 @@ template<typename... Args>
 factory_registrator<I, T, pass_name, unregister>::factory_registrator(priorities priority, Args &&...args)
       : _name(std::string())
       , _priority(priority)
+      , _factory(std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...))
 {
-   r.register_factory(
-         _name, _priority, std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...));
+   r.register_factory(_name, _priority, _factory);
 }
 
 template<typename I, typename T, bool pass_name, bool unregister>
@@ -87,9 +104,33 @@ factory_registrator<I, T, pass_name, unregister>::factory_registrator(
       const std::string &instance, priorities priority, Args &&...args)
       : _name(instance)
       , _priority(priority)
+      , _factory(std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...))
+{
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, typename T, bool pass_name, bool unregister>
+template<typename... D, typename... Args>
+factory_registrator<I, T, pass_name, unregister>::factory_registrator(
+      depends_on<D...>, priorities priority, Args &&...args)
+      : _name(std::string())
+      , _priority(priority)
+      , _factory(std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...))
+{
+   _factory->set_dependencies(depends_on<D...>::types());
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, typename T, bool pass_name, bool unregister>
+template<typename... D, typename... Args>
+factory_registrator<I, T, pass_name, unregister>::factory_registrator(
+      depends_on<D...>, const std::string &instance, priorities priority, Args &&...args)
+      : _name(instance)
+      , _priority(priority)
+      , _factory(std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...))
 {
-   r.register_factory(
-         _name, _priority, std::make_shared<factory<I, T, pass_name, Args...>>(std::forward<Args>(args)...));
+   _factory->set_dependencies(depends_on<D...>::types());
+   r.register_factory(_name, _priority, _factory);
 }
 
 template<typename I, typename T, bool pass_name, bool unregister>
@@ -97,7 +138,7 @@ factory_registrator<I, T, pass_name, unregister>::~factory_registrator()
 {
    if (unregister)
    {
-      r.unregister_factory(_name, _priority, typeid(I));
+      r.unregister_factory(_name, _priority, _factory);
    }
 }
 
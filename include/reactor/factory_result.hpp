@@ -18,6 +18,9 @@
 #include <memory>
 #include <stdexcept>
 #include <typeindex>
+#include <utility>
+
+#include "lifecycle.hpp"
 
 namespace iws {
 namespace reactor {
@@ -47,10 +50,23 @@ class factory_result
     */
    template<typename T>
    std::shared_ptr<void> get();
+   /**
+    * @brief Gets the stored object, checking against a runtime type
+    */
+   std::shared_ptr<void> get(const std::type_info &type);
+   /**
+    * @brief the lifecycle interface of the stored object, nullptr if it doesn't implement it
+    */
+   lifecycle *get_lifecycle() const { return _lifecycle; }
+   /**
+    * @brief keep owner alive until the stored object is destructed (like the library its code comes from)
+    */
+   void retain(std::shared_ptr<const void> owner);
 
  private:
    std::shared_ptr<void> _obj;
    std::type_index _id;
+   lifecycle *_lifecycle;
 };
 
 // ----
@@ -59,13 +75,27 @@ template<typename T>
 factory_result::factory_result(std::shared_ptr<T> obj)
       : _obj(obj)
       , _id(typeid(T))
+      , _lifecycle(detail::as_lifecycle(obj.get()))
 {
 }
 
 template<typename T>
 std::shared_ptr<void> factory_result::get()
 {
-   if (_id != typeid(T))
+   return get(typeid(T));
+}
+
+inline void factory_result::retain(std::shared_ptr<const void> owner)
+{
+   // Members are destructed in reverse order, so the object goes before its owner
+   auto holder = std::make_shared<std::pair<std::shared_ptr<const void>, std::shared_ptr<void>>>(
+         std::move(owner), _obj);
+   _obj = std::shared_ptr<void>(holder, _obj.get());
+}
+
+inline std::shared_ptr<void> factory_result::get(const std::type_info &type)
+{
+   if (_id != type)
    {
       throw std::logic_error("Factory returned bad type");
    }
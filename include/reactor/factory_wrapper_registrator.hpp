@@ -15,8 +15,10 @@
 #ifndef __IWS_REACTOR_FACTORY_WRAPPER_REGISTRATOR_HPP__
 #define __IWS_REACTOR_FACTORY_WRAPPER_REGISTRATOR_HPP__
 
+#include <memory>
 #include <string>
 
+#include "depends_on.hpp"
 #include "factory_wrapper.hpp"
 #include "priorities.hpp"
 #include "r.hpp"
@@ -56,11 +58,27 @@ class factory_wrapper_registrator
    factory_wrapper_registrator(const std::string &instance, priorities priority,
          const typename factory_wrapper<I>::producer_function &producer);
 
+   /**
+    * @brief factory_wrapper_registrator default instance constructor with declared dependencies
+    * @param dependencies lists the interfaces the producer gets (see depends_on)
+    */
+   template<typename... D>
+   factory_wrapper_registrator(depends_on<D...> dependencies, priorities priority,
+         const typename factory_wrapper<I>::producer_function &producer);
+   /**
+    * @brief factory_wrapper_registrator instance specific constructor with declared dependencies
+    * @param dependencies lists the interfaces the producer gets (see depends_on)
+    */
+   template<typename... D>
+   factory_wrapper_registrator(depends_on<D...> dependencies, const std::string &instance, priorities priority,
+         const typename factory_wrapper<I>::producer_function &producer);
+
    ~factory_wrapper_registrator();
 
  private:
    const std::string _name;
    const priorities _priority;
+   const std::shared_ptr<factory_base> _factory; // Only this one is unregistered, not a factory it lost against
 };
 
 // ----
@@ -70,8 +88,9 @@ factory_wrapper_registrator<I, unregister>::factory_wrapper_registrator(
       priorities priority, const typename factory_wrapper<I>::producer_function &producer)
       : _name(std::string())
       , _priority(priority)
+      , _factory(std::make_shared<factory_wrapper<I>>(producer))
 {
-   r.register_factory(_name, _priority, std::make_shared<factory_wrapper<I>>(producer));
+   r.register_factory(_name, _priority, _factory);
 }
 
 template<typename I, bool unregister>
@@ -79,8 +98,33 @@ factory_wrapper_registrator<I, unregister>::factory_wrapper_registrator(
       const std::string &instance, priorities priority, const typename factory_wrapper<I>::producer_function &producer)
       : _name(instance)
       , _priority(priority)
+      , _factory(std::make_shared<factory_wrapper<I>>(producer))
+{
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, bool unregister>
+template<typename... D>
+factory_wrapper_registrator<I, unregister>::factory_wrapper_registrator(
+      depends_on<D...>, priorities priority, const typename factory_wrapper<I>::producer_function &producer)
+      : _name(std::string())
+      , _priority(priority)
+      , _factory(std::make_shared<factory_wrapper<I>>(producer))
+{
+   _factory->set_dependencies(depends_on<D...>::types());
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, bool unregister>
+template<typename... D>
+factory_wrapper_registrator<I, unregister>::factory_wrapper_registrator(depends_on<D...>,
+      const std::string &instance, priorities priority, const typename factory_wrapper<I>::producer_function &producer)
+      : _name(instance)
+      , _priority(priority)
+      , _factory(std::make_shared<factory_wrapper<I>>(producer))
 {
-   r.register_factory(_name, _priority, std::make_shared<factory_wrapper<I>>(producer));
+   _factory->set_dependencies(depends_on<D...>::types());
+   r.register_factory(_name, _priority, _factory);
 }
 
 template<typename I, bool unregister>
@@ -88,7 +132,7 @@ factory_wrapper_registrator<I, unregister>::~factory_wrapper_registrator()
 {
    if (unregister)
    {
-      r.unregister_factory(_name, _priority, typeid(I));
+      r.unregister_factory(_name, _priority, _factory);
    }
 }
 
@@ -0,0 +1,738 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_FLAT_MAP_HPP__
+#define __IWS_REACTOR_FLAT_MAP_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REACTOR_FLAT_MAP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define REACTOR_FLAT_MAP_NEON
+#include <arm_neon.h>
+#endif
+
+namespace iws {
+namespace reactor {
+namespace detail {
+
+/**
+ * @brief One group of control bytes of a flat_map, matched in parallel
+ *
+ * Every slot has a control byte: the high bit is set for empty and deleted slots, full slots store the low 7 bits of
+ * their hash. A lookup compares a whole group against those 7 bits at once and only touches the slots that match.
+ */
+class flat_map_group
+{
+ public:
+   static const size_t width = 16;
+
+   static const int8_t empty = -128;  // 0b10000000
+   static const int8_t deleted = -2;  // 0b11111110
+
+   typedef uint32_t mask_type; // One bit per slot of the group
+
+   explicit flat_map_group(const int8_t *ctrl);
+
+   mask_type match(int8_t h2) const;
+   mask_type match_empty() const;
+   mask_type match_free() const; // Empty or deleted
+
+   static unsigned lowest(mask_type mask);
+
+ private:
+#if defined(REACTOR_FLAT_MAP_SSE2)
+   __m128i _ctrl;
+#elif defined(REACTOR_FLAT_MAP_NEON)
+   int8x16_t _ctrl;
+
+   static mask_type to_mask(uint8x16_t lanes);
+#else
+   int8_t _ctrl[width];
+#endif
+};
+
+} // namespace detail
+
+/**
+ * @brief Open addressing hash map with SIMD probed control bytes (Swiss table layout)
+ *
+ * Slots live in one flat array, so a lookup usually costs one control group load and one slot compare instead of
+ * chasing tree nodes. Probing walks whole groups in triangular order, erased slots become tombstones unless their
+ * group still has an empty slot.
+ * The interface follows the subset of std::map used in the library; iteration order is unspecified, and unlike
+ * std::map every insertion may invalidate iterators and references.
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_map
+{
+ public:
+   typedef Key key_type;
+   typedef T mapped_type;
+   typedef std::pair<const Key, T> value_type;
+   typedef size_t size_type;
+
+   template<bool Const>
+   class iterator_base
+   {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef typename flat_map::value_type value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef typename std::conditional<Const, const value_type *, value_type *>::type pointer;
+      typedef typename std::conditional<Const, const value_type &, value_type &>::type reference;
+
+      iterator_base();
+      // Allows iterator -> const_iterator
+      template<bool OtherConst, typename = typename std::enable_if<Const || !OtherConst>::type>
+      iterator_base(const iterator_base<OtherConst> &other);
+
+      reference operator*() const { return *_slot; }
+      pointer operator->() const { return _slot; }
+
+      iterator_base &operator++();
+      iterator_base operator++(int);
+
+      template<bool OtherConst>
+      bool operator==(const iterator_base<OtherConst> &other) const
+      {
+         return _ctrl == other._ctrl;
+      }
+      template<bool OtherConst>
+      bool operator!=(const iterator_base<OtherConst> &other) const
+      {
+         return _ctrl != other._ctrl;
+      }
+
+    private:
+      iterator_base(const int8_t *ctrl, const int8_t *ctrl_end, pointer slot);
+      void skip_free();
+
+      const int8_t *_ctrl;
+      const int8_t *_ctrl_end;
+      pointer _slot;
+
+      template<bool>
+      friend class iterator_base;
+      friend class flat_map;
+   };
+
+   typedef iterator_base<false> iterator;
+   typedef iterator_base<true> const_iterator;
+
+   flat_map();
+   flat_map(const flat_map &other);
+   flat_map(flat_map &&other) noexcept;
+   flat_map &operator=(flat_map other) noexcept;
+   ~flat_map();
+
+   iterator begin();
+   iterator end();
+   const_iterator begin() const;
+   const_iterator end() const;
+
+   size_type size() const { return _size; }
+   bool empty() const { return 0 == _size; }
+   size_type capacity() const { return _capacity; }
+
+   iterator find(const key_type &key);
+   const_iterator find(const key_type &key) const;
+   size_type count(const key_type &key) const;
+
+   std::pair<iterator, bool> insert(const value_type &value);
+   std::pair<iterator, bool> insert(value_type &&value);
+   template<typename... Args>
+   std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args);
+   mapped_type &operator[](const key_type &key);
+
+   void erase(const_iterator pos);
+   size_type erase(const key_type &key);
+   void clear();
+
+   /**
+    * @brief make room for at least count items without rehashing
+    */
+   void reserve(size_type count);
+
+   void swap(flat_map &other) noexcept;
+
+ private:
+   static const size_t npos = static_cast<size_t>(-1);
+   static const size_t min_capacity = detail::flat_map_group::width;
+
+   int8_t *_ctrl;
+   value_type *_slots;
+   size_t _capacity; // Zero or a power of two multiple of the group width
+   size_t _size;
+   size_t _deleted;
+   Hash _hash;
+   KeyEqual _equal;
+
+   static size_t mix(size_t hash);
+   static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+   static size_t max_load(size_t capacity) { return capacity - capacity / 8; }
+
+   size_t find_index(const key_type &key, size_t hash) const;
+   size_t find_free(size_t hash) const;
+   size_t prepare_insert(size_t hash);
+   void rehash(size_t capacity);
+   void destroy_all();
+   iterator make_iterator(size_t i);
+   const_iterator make_iterator(size_t i) const;
+};
+
+// ----
+
+namespace detail {
+
+#if defined(REACTOR_FLAT_MAP_SSE2)
+
+inline flat_map_group::flat_map_group(const int8_t *ctrl)
+      : _ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+{
+}
+
+inline flat_map_group::mask_type flat_map_group::match(int8_t h2) const
+{
+   return static_cast<mask_type>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+}
+
+inline flat_map_group::mask_type flat_map_group::match_empty() const
+{
+   return match(empty);
+}
+
+inline flat_map_group::mask_type flat_map_group::match_free() const
+{
+   // Full slots have the high bit cleared
+   return static_cast<mask_type>(_mm_movemask_epi8(_ctrl));
+}
+
+#elif defined(REACTOR_FLAT_MAP_NEON)
+
+inline flat_map_group::flat_map_group(const int8_t *ctrl)
+      : _ctrl(vld1q_s8(ctrl))
+{
+}
+
+inline flat_map_group::mask_type flat_map_group::to_mask(uint8x16_t lanes)
+{
+   static const uint8_t bits[width] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+   const uint8x16_t masked = vandq_u8(lanes, vld1q_u8(bits));
+   return static_cast<mask_type>(vaddv_u8(vget_low_u8(masked))) |
+          (static_cast<mask_type>(vaddv_u8(vget_high_u8(masked))) << 8);
+}
+
+inline flat_map_group::mask_type flat_map_group::match(int8_t h2) const
+{
+   return to_mask(vceqq_s8(_ctrl, vdupq_n_s8(h2)));
+}
+
+inline flat_map_group::mask_type flat_map_group::match_empty() const
+{
+   return match(empty);
+}
+
+inline flat_map_group::mask_type flat_map_group::match_free() const
+{
+   return to_mask(vcltzq_s8(_ctrl));
+}
+
+#else
+
+inline flat_map_group::flat_map_group(const int8_t *ctrl)
+{
+   std::memcpy(_ctrl, ctrl, width);
+}
+
+inline flat_map_group::mask_type flat_map_group::match(int8_t h2) const
+{
+   mask_type result = 0;
+   for (size_t i = 0; i < width; ++i)
+   {
+      result |= static_cast<mask_type>(_ctrl[i] == h2) << i;
+   }
+   return result;
+}
+
+inline flat_map_group::mask_type flat_map_group::match_empty() const
+{
+   return match(empty);
+}
+
+inline flat_map_group::mask_type flat_map_group::match_free() const
+{
+   mask_type result = 0;
+   for (size_t i = 0; i < width; ++i)
+   {
+      result |= static_cast<mask_type>(_ctrl[i] < 0) << i;
+   }
+   return result;
+}
+
+#endif
+
+inline unsigned flat_map_group::lowest(mask_type mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+   unsigned result = 0;
+   while (0 == (mask & 1))
+   {
+      mask >>= 1;
+      ++result;
+   }
+   return result;
+#endif
+}
+
+} // namespace detail
+
+// -- iterator
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::iterator_base()
+      : _ctrl(nullptr)
+      , _ctrl_end(nullptr)
+      , _slot(nullptr)
+{
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+template<bool OtherConst, typename>
+flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::iterator_base(const iterator_base<OtherConst> &other)
+      : _ctrl(other._ctrl)
+      , _ctrl_end(other._ctrl_end)
+      , _slot(other._slot)
+{
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::iterator_base(
+      const int8_t *ctrl, const int8_t *ctrl_end, pointer slot)
+      : _ctrl(ctrl)
+      , _ctrl_end(ctrl_end)
+      , _slot(slot)
+{
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+void flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::skip_free()
+{
+   while (_ctrl != _ctrl_end && *_ctrl < 0)
+   {
+      ++_ctrl;
+      ++_slot;
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+typename flat_map<Key, T, Hash, KeyEqual>::template iterator_base<Const> &
+flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::operator++()
+{
+   ++_ctrl;
+   ++_slot;
+   skip_free();
+   return *this;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<bool Const>
+typename flat_map<Key, T, Hash, KeyEqual>::template iterator_base<Const>
+flat_map<Key, T, Hash, KeyEqual>::iterator_base<Const>::operator++(int)
+{
+   iterator_base result(*this);
+   ++(*this);
+   return result;
+}
+
+// -- map
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+flat_map<Key, T, Hash, KeyEqual>::flat_map()
+      : _ctrl(nullptr)
+      , _slots(nullptr)
+      , _capacity(0)
+      , _size(0)
+      , _deleted(0)
+{
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+flat_map<Key, T, Hash, KeyEqual>::flat_map(const flat_map &other)
+      : flat_map()
+{
+   _hash = other._hash;
+   _equal = other._equal;
+
+   reserve(other.size());
+   for (const auto &item : other)
+   {
+      const size_t i = find_free(mix(_hash(item.first)));
+      new (&_slots[i]) value_type(item);
+      _ctrl[i] = h2(mix(_hash(item.first)));
+      ++_size;
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+flat_map<Key, T, Hash, KeyEqual>::flat_map(flat_map &&other) noexcept
+      : flat_map()
+{
+   swap(other);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+flat_map<Key, T, Hash, KeyEqual> &flat_map<Key, T, Hash, KeyEqual>::operator=(flat_map other) noexcept
+{
+   swap(other);
+   return *this;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+flat_map<Key, T, Hash, KeyEqual>::~flat_map()
+{
+   destroy_all();
+   delete[] _ctrl;
+   ::operator delete(_slots);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::iterator flat_map<Key, T, Hash, KeyEqual>::begin()
+{
+   iterator result(_ctrl, _ctrl + _capacity, _slots);
+   result.skip_free();
+   return result;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::iterator flat_map<Key, T, Hash, KeyEqual>::end()
+{
+   return make_iterator(_capacity);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::const_iterator flat_map<Key, T, Hash, KeyEqual>::begin() const
+{
+   const_iterator result(_ctrl, _ctrl + _capacity, _slots);
+   result.skip_free();
+   return result;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::const_iterator flat_map<Key, T, Hash, KeyEqual>::end() const
+{
+   return make_iterator(_capacity);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::iterator flat_map<Key, T, Hash, KeyEqual>::find(const key_type &key)
+{
+   const size_t i = find_index(key, mix(_hash(key)));
+   return npos == i ? end() : make_iterator(i);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::const_iterator flat_map<Key, T, Hash, KeyEqual>::find(
+      const key_type &key) const
+{
+   const size_t i = find_index(key, mix(_hash(key)));
+   return npos == i ? end() : make_iterator(i);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::size_type flat_map<Key, T, Hash, KeyEqual>::count(
+      const key_type &key) const
+{
+   return npos == find_index(key, mix(_hash(key))) ? 0 : 1;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+std::pair<typename flat_map<Key, T, Hash, KeyEqual>::iterator, bool> flat_map<Key, T, Hash, KeyEqual>::insert(
+      const value_type &value)
+{
+   return try_emplace(value.first, value.second);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+std::pair<typename flat_map<Key, T, Hash, KeyEqual>::iterator, bool> flat_map<Key, T, Hash, KeyEqual>::insert(
+      value_type &&value)
+{
+   return try_emplace(value.first, std::move(value.second));
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+template<typename... Args>
+std::pair<typename flat_map<Key, T, Hash, KeyEqual>::iterator, bool> flat_map<Key, T, Hash, KeyEqual>::try_emplace(
+      const key_type &key, Args &&...args)
+{
+   const size_t hash = mix(_hash(key));
+
+   size_t i = find_index(key, hash);
+   if (npos != i)
+   {
+      return {make_iterator(i), false};
+   }
+
+   i = prepare_insert(hash);
+   new (&_slots[i]) value_type(std::piecewise_construct, std::forward_as_tuple(key),
+         std::forward_as_tuple(std::forward<Args>(args)...));
+
+   // Only mark the slot full once the value is constructed, so a throwing constructor leaves the map intact
+   if (detail::flat_map_group::deleted == _ctrl[i])
+   {
+      --_deleted;
+   }
+   _ctrl[i] = h2(hash);
+   ++_size;
+
+   return {make_iterator(i), true};
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::mapped_type &flat_map<Key, T, Hash, KeyEqual>::operator[](
+      const key_type &key)
+{
+   return try_emplace(key).first->second;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::erase(const_iterator pos)
+{
+   const size_t i = static_cast<size_t>(pos._ctrl - _ctrl);
+   _slots[i].~value_type();
+   --_size;
+
+   // A probe only continues past a group that has no empty slot. If this group has one, no probe can be running
+   // through this slot, so it can become empty again instead of a tombstone.
+   const size_t group_start = i & ~(detail::flat_map_group::width - 1);
+   if (0 != detail::flat_map_group(_ctrl + group_start).match_empty())
+   {
+      _ctrl[i] = detail::flat_map_group::empty;
+   }
+   else
+   {
+      _ctrl[i] = detail::flat_map_group::deleted;
+      ++_deleted;
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::size_type flat_map<Key, T, Hash, KeyEqual>::erase(const key_type &key)
+{
+   const size_t i = find_index(key, mix(_hash(key)));
+   if (npos == i)
+   {
+      return 0;
+   }
+
+   erase(make_iterator(i));
+   return 1;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::clear()
+{
+   destroy_all();
+   if (0 != _capacity)
+   {
+      std::memset(_ctrl, detail::flat_map_group::empty, _capacity);
+   }
+   _size = 0;
+   _deleted = 0;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::reserve(size_type count)
+{
+   size_t capacity = min_capacity;
+   while (max_load(capacity) < count)
+   {
+      capacity *= 2;
+   }
+
+   if (capacity > _capacity)
+   {
+      rehash(capacity);
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::swap(flat_map &other) noexcept
+{
+   std::swap(_ctrl, other._ctrl);
+   std::swap(_slots, other._slots);
+   std::swap(_capacity, other._capacity);
+   std::swap(_size, other._size);
+   std::swap(_deleted, other._deleted);
+   std::swap(_hash, other._hash);
+   std::swap(_equal, other._equal);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+size_t flat_map<Key, T, Hash, KeyEqual>::mix(size_t hash)
+{
+   // Std hashes of pointers and integers are often the identity, spread them before using the low 7 bits as tag
+   uint64_t h = static_cast<uint64_t>(hash);
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdull;
+   h ^= h >> 33;
+   return static_cast<size_t>(h);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+size_t flat_map<Key, T, Hash, KeyEqual>::find_index(const key_type &key, size_t hash) const
+{
+   if (0 == _capacity)
+   {
+      return npos;
+   }
+
+   const size_t group_mask = _capacity / detail::flat_map_group::width - 1;
+   size_t group = (hash >> 7) & group_mask;
+   const int8_t tag = h2(hash);
+
+   for (size_t step = 1;; ++step)
+   {
+      const size_t base = group * detail::flat_map_group::width;
+      const detail::flat_map_group g(_ctrl + base);
+
+      for (auto mask = g.match(tag); 0 != mask; mask &= mask - 1)
+      {
+         const size_t i = base + detail::flat_map_group::lowest(mask);
+         if (_equal(_slots[i].first, key))
+         {
+            return i;
+         }
+      }
+
+      if (0 != g.match_empty())
+      {
+         return npos;
+      }
+
+      // Triangular steps visit every group when their count is a power of two
+      group = (group + step) & group_mask;
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+size_t flat_map<Key, T, Hash, KeyEqual>::find_free(size_t hash) const
+{
+   const size_t group_mask = _capacity / detail::flat_map_group::width - 1;
+   size_t group = (hash >> 7) & group_mask;
+
+   for (size_t step = 1;; ++step)
+   {
+      const size_t base = group * detail::flat_map_group::width;
+      const auto mask = detail::flat_map_group(_ctrl + base).match_free();
+      if (0 != mask)
+      {
+         return base + detail::flat_map_group::lowest(mask);
+      }
+
+      group = (group + step) & group_mask;
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+size_t flat_map<Key, T, Hash, KeyEqual>::prepare_insert(size_t hash)
+{
+   if (_size + _deleted + 1 > max_load(_capacity))
+   {
+      // Mostly tombstones: clean up in place, otherwise grow
+      if (0 != _capacity && _size + 1 <= max_load(_capacity) / 2)
+      {
+         rehash(_capacity);
+      }
+      else
+      {
+         rehash(0 == _capacity ? min_capacity : _capacity * 2);
+      }
+   }
+
+   return find_free(hash);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::rehash(size_t capacity)
+{
+   flat_map fresh;
+   fresh._hash = _hash;
+   fresh._equal = _equal;
+   fresh._ctrl = new int8_t[capacity];
+   fresh._slots = static_cast<value_type *>(::operator new(capacity * sizeof(value_type)));
+   fresh._capacity = capacity;
+   std::memset(fresh._ctrl, detail::flat_map_group::empty, capacity);
+
+   for (size_t i = 0; i < _capacity; ++i)
+   {
+      if (_ctrl[i] >= 0)
+      {
+         const size_t hash = mix(_hash(_slots[i].first));
+         const size_t target = fresh.find_free(hash);
+         new (&fresh._slots[target]) value_type(std::move(_slots[i]));
+         fresh._ctrl[target] = h2(hash);
+         ++fresh._size;
+      }
+   }
+
+   swap(fresh);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+void flat_map<Key, T, Hash, KeyEqual>::destroy_all()
+{
+   for (size_t i = 0; i < _capacity; ++i)
+   {
+      if (_ctrl[i] >= 0)
+      {
+         _slots[i].~value_type();
+      }
+   }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::iterator flat_map<Key, T, Hash, KeyEqual>::make_iterator(size_t i)
+{
+   return iterator(_ctrl + i, _ctrl + _capacity, _slots + i);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual>
+typename flat_map<Key, T, Hash, KeyEqual>::const_iterator flat_map<Key, T, Hash, KeyEqual>::make_iterator(
+      size_t i) const
+{
+   return const_iterator(_ctrl + i, _ctrl + _capacity, _slots + i);
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_FLAT_MAP_HPP__
@@ -15,19 +15,123 @@
 #ifndef __IWS_REACTOR_INDEX_HPP__
 #define __IWS_REACTOR_INDEX_HPP__
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <typeindex>
-#include <utility>
+
+#include "name_registry.hpp"
+#include "string_view_polyfil.hpp"
 
 namespace iws {
 namespace reactor {
 
+namespace pf = ::iws::polyfil;
+
 /**
  * @brief Link to a reactor managed instance
+ *
+ * Holds the type and the interned instance name (see name_registry) with a precomputed hash, so comparing and
+ * hashing an index never touches the characters of the name.
  */
-typedef std::pair<std::type_index, std::string> index;
+class index
+{
+ public:
+   /**
+    * @brief index of the default instance of a type
+    */
+   explicit index(const std::type_index &type);
+   /**
+    * @brief index of a named instance of a type, interns the name if necessary
+    */
+   index(const std::type_index &type, pf::string_view name);
+
+   /**
+    * @brief looks up an index without interning the name
+    * @param result is only assigned if the name was already interned
+    * @return false if the name was never interned, so there can not be anything registered with it
+    */
+   static bool find(const std::type_index &type, pf::string_view name, index &result);
+
+   const std::type_index &get_type() const { return _type; }
+   const std::string &get_name() const { return *_name; }
+   name_registry::id_type get_name_id() const { return _name_id; }
+   size_t get_hash() const { return _hash; }
+
+   bool operator==(const index &other) const
+   {
+      return _hash == other._hash && _name_id == other._name_id && _type == other._type;
+   }
+   bool operator!=(const index &other) const { return !(*this == other); }
+   bool operator<(const index &other) const
+   {
+      if (_hash != other._hash)
+         return _hash < other._hash;
+      if (_name_id != other._name_id)
+         return _name_id < other._name_id;
+      return _type < other._type;
+   }
+
+ private:
+   index(const std::type_index &type, const name_registry::entry &name);
+
+   std::type_index _type;
+   const std::string *_name;
+   size_t _hash;
+   name_registry::id_type _name_id;
+
+   static size_t make_hash(const std::type_index &type, name_registry::id_type name_id);
+};
+
+// ----
+
+inline index::index(const std::type_index &type)
+      : index(type, name_registry::empty())
+{
+}
+
+inline index::index(const std::type_index &type, pf::string_view name)
+      : index(type, name_registry::instance().intern(name))
+{
+}
+
+inline index::index(const std::type_index &type, const name_registry::entry &name)
+      : _type(type)
+      , _name(name.name)
+      , _hash(make_hash(type, name.id))
+      , _name_id(name.id)
+{
+}
+
+inline bool index::find(const std::type_index &type, pf::string_view name, index &result)
+{
+   name_registry::entry entry;
+   if (!name_registry::instance().find(name, entry))
+   {
+      return false;
+   }
+
+   result = index(type, entry);
+   return true;
+}
+
+inline size_t index::make_hash(const std::type_index &type, name_registry::id_type name_id)
+{
+   // Fibonacci hashing spreads the small sequential name ids over the whole range
+   return type.hash_code() ^ (static_cast<size_t>(name_id) * static_cast<size_t>(0x9E3779B97F4A7C15ull));
+}
 
 } // namespace reactor
 } // namespace iws
 
+namespace std {
+
+template<>
+struct hash<::iws::reactor::index>
+{
+   size_t operator()(const ::iws::reactor::index &id) const { return id.get_hash(); }
+};
+
+} // namespace std
+
 #endif //__IWS_REACTOR_INDEX_HPP__
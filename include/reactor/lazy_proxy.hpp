@@ -0,0 +1,137 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_LAZY_PROXY_HPP__
+#define __IWS_REACTOR_LAZY_PROXY_HPP__
+
+#include <atomic>
+
+#include "index.hpp"
+#include "r.hpp"
+#include "reactor.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Stands in for an object of a reactor that is only constructed on first use
+ *
+ * Handing out a proxy (reactor::get_lazy()) costs nothing, so services pulled in for rarely used code paths don't
+ * build their dependencies at startup. The first access constructs the object, later ones are a single atomic load.
+ * A proxy got by a constructor makes the object a dependency of the constructed one when it resolves (see
+ * reactor::get_for()). Like the reference pulleys the resolved pointer is not refreshed by reset_objects(), proxies
+ * must not outlive the objects of the reactor.
+ */
+template<typename T>
+class lazy_proxy
+{
+ public:
+   lazy_proxy(const lazy_proxy &other);
+   lazy_proxy &operator=(const lazy_proxy &other);
+
+   /**
+    * @brief get the object, constructing it on first use
+    */
+   T *get() const;
+   T *operator->() const { return get(); }
+   T &operator*() const { return *get(); }
+
+   /**
+    * @brief check if the proxy has already resolved its object
+    */
+   bool is_resolved() const { return nullptr != _obj.load(std::memory_order_acquire); }
+
+ private:
+   lazy_proxy(reactor &owner, const index &id);
+
+   T *resolve() const;
+
+   reactor *_reactor;
+   index _id;
+   index _dependent;
+   bool _has_dependent; // Got by a constructor, the dependency is recorded when resolved
+   mutable std::atomic<T *> _obj;
+
+   friend class reactor;
+};
+
+// ----
+
+template<typename T>
+lazy_proxy<T>::lazy_proxy(reactor &owner, const index &id)
+      : _reactor(&owner)
+      , _id(id)
+      , _dependent(id)
+      , _has_dependent(owner.current_construction(_dependent))
+      , _obj(nullptr)
+{
+}
+
+template<typename T>
+lazy_proxy<T>::lazy_proxy(const lazy_proxy &other)
+      : _reactor(other._reactor)
+      , _id(other._id)
+      , _dependent(other._dependent)
+      , _has_dependent(other._has_dependent)
+      , _obj(other._obj.load(std::memory_order_acquire))
+{
+}
+
+template<typename T>
+lazy_proxy<T> &lazy_proxy<T>::operator=(const lazy_proxy &other)
+{
+   _reactor = other._reactor;
+   _id = other._id;
+   _dependent = other._dependent;
+   _has_dependent = other._has_dependent;
+   _obj.store(other._obj.load(std::memory_order_acquire), std::memory_order_release);
+   return *this;
+}
+
+template<typename T>
+T *lazy_proxy<T>::get() const
+{
+   T *obj = _obj.load(std::memory_order_acquire);
+   if (nullptr != obj)
+   {
+      return obj;
+   }
+
+   return resolve();
+}
+
+template<typename T>
+T *lazy_proxy<T>::resolve() const
+{
+   // Racing threads get the same object from the reactor, storing it twice is harmless
+   T *obj = &_reactor->template get<T>(_id, nullptr, 0);
+   if (_has_dependent)
+   {
+      _reactor->record_lazy_dependency(_dependent, _id);
+   }
+   _obj.store(obj, std::memory_order_release);
+   return obj;
+}
+
+template<typename T>
+lazy_proxy<T> reactor::get_lazy(const typed_contract<T> &contract)
+{
+   return lazy_proxy<T>(*this, contract.get_index());
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_LAZY_PROXY_HPP__
@@ -0,0 +1,77 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_LIFECYCLE_HPP__
+#define __IWS_REACTOR_LIFECYCLE_HPP__
+
+#include <type_traits>
+
+#include "utils.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Optional second construction phase of reactor managed objects
+ *
+ * Objects implementing it should only wire their dependencies in the constructor, and do the expensive work (warming
+ * caches, connecting) in start(). reactor::start_services() calls start() outside of any reactor lock, in parallel for
+ * objects not depending on each other; reset_objects() calls stop() the same way, dependents first, on up to
+ * std::thread::hardware_concurrency() threads, before destructing the objects.
+ */
+class lifecycle
+{
+ public:
+   virtual ~lifecycle() {}
+
+   virtual void start() = 0;
+   /**
+    * @brief undo start(), only called if start() succeeded. Must not throw, exceptions are ignored.
+    */
+   virtual void stop() = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief the lifecycle interface of an object, nullptr if it doesn't implement it
+ */
+template<typename T, enable_if_t<std::is_base_of<lifecycle, T>::value, int> = 0>
+lifecycle *as_lifecycle(T *obj)
+{
+   return obj;
+}
+
+template<typename T,
+      enable_if_t<!std::is_base_of<lifecycle, T>::value && std::is_polymorphic<T>::value, int> = 0>
+lifecycle *as_lifecycle(T *obj)
+{
+   // The implementation behind an interface may still have one
+   return dynamic_cast<lifecycle *>(obj);
+}
+
+template<typename T,
+      enable_if_t<!std::is_base_of<lifecycle, T>::value && !std::is_polymorphic<T>::value, int> = 0>
+lifecycle *as_lifecycle(T *)
+{
+   return nullptr;
+}
+
+} // namespace detail
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_LIFECYCLE_HPP__
@@ -0,0 +1,86 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_NAME_REGISTRY_HPP__
+#define __IWS_REACTOR_NAME_REGISTRY_HPP__
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "might_shared_mutex.hpp"
+#include "string_view_polyfil.hpp"
+
+namespace iws {
+namespace reactor {
+
+namespace pf = ::iws::polyfil;
+
+/**
+ * @brief Process wide interning table for instance names
+ *
+ * Every distinct instance name is stored exactly once and gets a small integer id, so indexes can be compared and
+ * hashed without touching the characters of the name. The empty (default instance) name always has the id 0.
+ * Interned names are never released, their addresses stay valid until the end of the process.
+ */
+class name_registry
+{
+ public:
+   typedef uint32_t id_type;
+
+   struct entry
+   {
+      id_type id;
+      const std::string *name;
+   };
+
+   /**
+    * @brief get the global registry
+    *
+    * The registry is intentionally never destructed so indexes stay usable during static deinit.
+    */
+   static name_registry &instance();
+
+   /**
+    * @brief get the interned entry of a name, adding it if it was not interned yet
+    */
+   entry intern(pf::string_view name);
+
+   /**
+    * @brief look up a name without interning it
+    * @return false if the name was never interned
+    */
+   bool find(pf::string_view name, entry &result) const;
+
+   /**
+    * @brief the entry of the empty (default instance) name
+    */
+   static entry empty();
+
+ private:
+   name_registry();
+   name_registry(const name_registry &) = delete;
+   name_registry &operator=(const name_registry &) = delete;
+
+   mutable pf::might_shared_mutex _mutex;
+   std::deque<std::string> _names; // deque so references to the names stay valid while growing
+   const std::string *_empty;
+   std::unordered_map<pf::string_view, id_type, pf::string_view_hash> _ids;
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_NAME_REGISTRY_HPP__
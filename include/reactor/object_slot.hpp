@@ -0,0 +1,134 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_OBJECT_SLOT_HPP__
+#define __IWS_REACTOR_OBJECT_SLOT_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Cached resolution of an object, valid for one reactor generation
+ *
+ * Generations are unique for the whole process (every reactor and every reset_objects() call takes a new one), so a
+ * slot filled by one reactor can never be mistaken for a hit by an other one.
+ * Writers publish the pointer with a seqlock like protocol, if two of them race the loser simply skips caching.
+ * The slot also remembers a failed factory lookup, tagged with the (equally process unique) factory generation of the
+ * reactor, so repeated probes for a missing optional service don't have to look up the registries.
+ */
+class object_slot
+{
+ public:
+   object_slot();
+   // Copies start empty, the cached pointer belongs to the original owner
+   object_slot(const object_slot &);
+   object_slot &operator=(const object_slot &);
+
+   /**
+    * @brief get the cached object
+    * @return nullptr if nothing is cached for the given generation
+    */
+   void *get(uint64_t generation) const;
+
+   /**
+    * @brief cache an object for the given generation
+    *
+    * The generation must be read before the object was looked up, so the pair can never outlive a reset.
+    */
+   void set(uint64_t generation, void *obj);
+
+   /**
+    * @brief check if no factory was found in the given factory generation
+    */
+   bool is_miss(uint64_t factory_generation) const;
+   /**
+    * @brief remember that no factory was found, the factory generation must be read before the lookup
+    */
+   void set_miss(uint64_t factory_generation);
+
+ private:
+   static const uint64_t busy = std::numeric_limits<uint64_t>::max();
+
+   std::atomic<uint64_t> _generation; // 0 means empty
+   std::atomic<void *> _obj;
+   std::atomic<uint64_t> _miss_generation; // 0 means no miss recorded
+};
+
+// ----
+
+inline object_slot::object_slot()
+      : _generation(0)
+      , _obj(nullptr)
+      , _miss_generation(0)
+{
+}
+
+inline object_slot::object_slot(const object_slot &)
+      : object_slot()
+{
+}
+
+inline object_slot &object_slot::operator=(const object_slot &)
+{
+   return *this;
+}
+
+inline void *object_slot::get(uint64_t generation) const
+{
+   if (_generation.load(std::memory_order_acquire) != generation)
+   {
+      return nullptr;
+   }
+
+   // Acquire keeps the recheck after the read: make sure no writer replaced the pointer while we were reading it
+   void *obj = _obj.load(std::memory_order_acquire);
+   if (_generation.load(std::memory_order_relaxed) != generation)
+   {
+      return nullptr;
+   }
+
+   return obj;
+}
+
+inline void object_slot::set(uint64_t generation, void *obj)
+{
+   uint64_t current = _generation.load(std::memory_order_relaxed);
+   if (busy == current || !_generation.compare_exchange_strong(current, busy, std::memory_order_acquire))
+   {
+      return; // An other writer is working on it
+   }
+
+   // Release publishes the busy mark first, a reader seeing the new pointer fails its recheck
+   _obj.store(obj, std::memory_order_release);
+   _generation.store(generation, std::memory_order_release);
+}
+
+inline bool object_slot::is_miss(uint64_t factory_generation) const
+{
+   return _miss_generation.load(std::memory_order_acquire) == factory_generation;
+}
+
+inline void object_slot::set_miss(uint64_t factory_generation)
+{
+   _miss_generation.store(factory_generation, std::memory_order_release);
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_OBJECT_SLOT_HPP__
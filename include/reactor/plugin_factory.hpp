@@ -0,0 +1,102 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_PLUGIN_FACTORY_HPP__
+#define __IWS_REACTOR_PLUGIN_FACTORY_HPP__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+#include "factory_base.hpp"
+#include "shared_library.hpp"
+
+#ifdef _WIN32
+#define REACTOR_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define REACTOR_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/**
+ * @brief define the entry point of a plugin_factory in a plugin library
+ *
+ * The plugin only needs the reactor headers, the object is constructed by the default constructor of T and returned
+ * as I.
+ */
+#define REACTOR_PLUGIN_FACTORY(symbol, I, T)                                                                          \
+   extern "C" REACTOR_PLUGIN_EXPORT void symbol(                                                                      \
+         const std::string &, std::unique_ptr<::iws::reactor::factory_result> &result)                                \
+   {                                                                                                                  \
+      result.reset(new ::iws::reactor::factory_result(std::shared_ptr<I>(std::make_shared<T>())));                    \
+   }
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Factory whose implementation lives in a shared library, opened when the first object is produced
+ *
+ * The library must export the entry point with REACTOR_PLUGIN_FACTORY. Every produced object keeps the library
+ * loaded, so it is closed once the reactor released them all (by reset_objects()) and opened again by the next
+ * produce(). Plugins nothing asks for are never opened.
+ */
+class plugin_factory : public factory_base
+{
+ public:
+   typedef void (*entry_point)(const std::string &instance, std::unique_ptr<factory_result> &result);
+
+   /**
+    * @param type is the type_info of the objects the plugin produces
+    * @param path of the shared library
+    * @param symbol is the name of the entry point defined by REACTOR_PLUGIN_FACTORY
+    */
+   plugin_factory(const std::type_info &type, const std::string &path, const std::string &symbol);
+
+   /**
+    * @throws std::runtime_error if the library or the entry point can't be loaded
+    */
+   virtual factory_result produce(const std::string &instance) const override;
+
+   /**
+    * @brief check if the library is currently open
+    */
+   bool is_loaded() const;
+
+ private:
+   struct loaded_plugin
+   {
+      explicit loaded_plugin(const std::string &path)
+            : library(path)
+            , entry(nullptr)
+      {
+      }
+
+      shared_library library;
+      entry_point entry;
+   };
+
+   std::shared_ptr<loaded_plugin> load() const;
+
+   const std::string _path;
+   const std::string _symbol;
+   mutable std::mutex _mutex;
+   mutable std::weak_ptr<loaded_plugin> _plugin; // Owned by the produced objects
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_PLUGIN_FACTORY_HPP__
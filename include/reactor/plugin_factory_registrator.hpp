@@ -0,0 +1,98 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_PLUGIN_FACTORY_REGISTRATOR_HPP__
+#define __IWS_REACTOR_PLUGIN_FACTORY_REGISTRATOR_HPP__
+
+#include <memory>
+#include <string>
+
+#include "plugin_factory.hpp"
+#include "priorities.hpp"
+#include "r.hpp"
+#include "reactor.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief registers a plugin_factory
+ *
+ * When constructed, registers a factory into the global reactor that opens the given library when the contract is
+ * first resolved. Can be used to register factories in static init.
+ *
+ * @tparam I The type returned by the factory (preferably an interface class).
+ */
+template<typename I, bool unregister = false>
+class plugin_factory_registrator
+{
+ public:
+   /**
+    * @brief plugin_factory_registrator default instance constructor
+    * @param priority is the registration priority of the factory
+    * @param path of the shared library
+    * @param symbol is the name of the entry point defined by REACTOR_PLUGIN_FACTORY
+    */
+   plugin_factory_registrator(priorities priority, const std::string &path, const std::string &symbol);
+   /**
+    * @brief plugin_factory_registrator instance specific constructor
+    * @param instance is the name of the instance that the registered factory produces
+    */
+   plugin_factory_registrator(
+         const std::string &instance, priorities priority, const std::string &path, const std::string &symbol);
+
+   ~plugin_factory_registrator();
+
+ private:
+   const std::string _name;
+   const priorities _priority;
+   const std::shared_ptr<factory_base> _factory; // Only this one is unregistered, not a factory it lost against
+};
+
+// ----
+
+template<typename I, bool unregister>
+plugin_factory_registrator<I, unregister>::plugin_factory_registrator(
+      priorities priority, const std::string &path, const std::string &symbol)
+      : _name(std::string())
+      , _priority(priority)
+      , _factory(std::make_shared<plugin_factory>(typeid(I), path, symbol))
+{
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, bool unregister>
+plugin_factory_registrator<I, unregister>::plugin_factory_registrator(
+      const std::string &instance, priorities priority, const std::string &path, const std::string &symbol)
+      : _name(instance)
+      , _priority(priority)
+      , _factory(std::make_shared<plugin_factory>(typeid(I), path, symbol))
+{
+   r.register_factory(_name, _priority, _factory);
+}
+
+template<typename I, bool unregister>
+plugin_factory_registrator<I, unregister>::~plugin_factory_registrator()
+{
+   if (unregister)
+   {
+      r.unregister_factory(_name, _priority, _factory);
+   }
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_PLUGIN_FACTORY_REGISTRATOR_HPP__
@@ -15,6 +15,7 @@
 #ifndef __IWS_REACTOR_PULLEY_HPP__
 #define __IWS_REACTOR_PULLEY_HPP__
 
+#include <atomic>
 #include <memory>
 
 #include "pulley_contract.hpp"
@@ -38,6 +39,9 @@ template<typename T, pulley_type type>
 class pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>
 {
  public:
+   pulley_base(const pulley_base &other);
+   pulley_base &operator=(const pulley_base &other);
+
    T *get() const;
 
  protected:
@@ -45,14 +49,19 @@ class pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>
    explicit pulley_base(const typed_contract<T> &contract);
 
  private:
-   const typed_contract<T> &_contract;
-   T &_obj;
+   const typed_contract<T> *_contract;
+   index _dependent;
+   bool _has_dependent; // False if not constructed by a constructor of the reactor
+   mutable std::atomic<T *> _obj; // Resolved on the first access if the factory is lazy
 };
 
 template<typename T, pulley_type type>
 class pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>
 {
  public:
+   pulley_base(const pulley_base &other);
+   pulley_base &operator=(const pulley_base &other);
+
    T *get() const;
 
  protected:
@@ -60,8 +69,10 @@ class pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>
    explicit pulley_base(const typed_contract<T> &contract);
 
  private:
-   const typed_contract<T> &_contract;
-   mutable T *_obj;
+   const typed_contract<T> *_contract;
+   index _dependent;
+   bool _has_dependent;
+   mutable std::atomic<T *> _obj;
 };
 
 template<typename T, pulley_type type>
@@ -94,41 +105,93 @@ class pulley : public pulley_base<T, type>
 
 template<typename T, pulley_type type>
 pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>::pulley_base(const typed_contract<T> &contract)
-      : _contract(contract)
-      , _obj(r.get(_contract))
+      : _contract(&contract)
+      , _dependent(contract.get_index())
+      , _has_dependent(r.current_construction(_dependent))
+      , _obj(r.get_unless_lazy(contract))
+{
+}
+
+template<typename T, pulley_type type>
+pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>::pulley_base(const pulley_base &other)
+      : _contract(other._contract)
+      , _dependent(other._dependent)
+      , _has_dependent(other._has_dependent)
+      , _obj(other._obj.load(std::memory_order_acquire))
+{
+}
+
+template<typename T, pulley_type type>
+pulley_base<T, type, detail::enable_if_t<reference_pulley == type>> &
+pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>::operator=(const pulley_base &other)
 {
+   _contract = other._contract;
+   _dependent = other._dependent;
+   _has_dependent = other._has_dependent;
+   _obj.store(other._obj.load(std::memory_order_acquire), std::memory_order_release);
+   return *this;
 }
 
 template<typename T, pulley_type type>
 T *pulley_base<T, type, detail::enable_if_t<reference_pulley == type>>::get() const
 {
-   return &_obj;
+   // Only null for a lazy factory, resolved like a lazy_reference_pulley
+   T *obj = _obj.load(std::memory_order_acquire);
+   if (nullptr == obj)
+   {
+      obj = _has_dependent ? &r.get_for(*_contract, _dependent) : &r.get(*_contract);
+      _obj.store(obj, std::memory_order_release);
+   }
+   return obj;
 }
 
 template<typename T, pulley_type type>
 pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>::pulley_base(const typed_contract<T> &contract)
-      : _contract(contract)
+      : _contract(&contract)
+      , _dependent(contract.get_index())
+      , _has_dependent(r.current_construction(_dependent))
       , _obj(nullptr)
 {
 }
 
+template<typename T, pulley_type type>
+pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>::pulley_base(const pulley_base &other)
+      : _contract(other._contract)
+      , _dependent(other._dependent)
+      , _has_dependent(other._has_dependent)
+      , _obj(other._obj.load(std::memory_order_acquire))
+{
+}
+
+template<typename T, pulley_type type>
+pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>> &
+pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>::operator=(const pulley_base &other)
+{
+   _contract = other._contract;
+   _dependent = other._dependent;
+   _has_dependent = other._has_dependent;
+   _obj.store(other._obj.load(std::memory_order_acquire), std::memory_order_release);
+   return *this;
+}
+
 template<typename T, pulley_type type>
 T *pulley_base<T, type, detail::enable_if_t<lazy_reference_pulley == type>>::get() const
 {
-   // No locking or anything here, r.get() is already thread safe, worst case we'll get the same object twice and store
-   // it twice.
-   // (storage of the pointer should be atomic as pointer size matches instruction size)
-   if (nullptr == _obj)
+   // No locking here, r.get() is already thread safe, worst case we'll get the same object twice and store it twice
+   T *obj = _obj.load(std::memory_order_acquire);
+   if (nullptr == obj)
    {
-      _obj = &r.get(_contract);
+      // Resolved after the dependent was constructed, the reactor has to learn about the dependency
+      obj = _has_dependent ? &r.get_for(*_contract, _dependent) : &r.get(*_contract);
+      _obj.store(obj, std::memory_order_release);
    }
-   return _obj;
+   return obj;
 }
 
 template<typename T, pulley_type type>
 pulley_base<T, type, detail::enable_if_t<shared_ptr_pulley == type>>::pulley_base(const typed_contract<T> &contract)
       : _contract(contract)
-      , _obj(r.get_ptr(r.get(_contract)))
+      , _obj(r.get_shared(_contract))
 {
 }
 
@@ -16,9 +16,16 @@
 #define __IWS_REACTOR_REACTOR_HPP__
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <typeindex>
 #include <vector>
 
@@ -27,22 +34,39 @@
 #include "addon_filter.hpp"
 #include "addon_filter_base.hpp"
 #include "addon_func_map.hpp"
+#include "async_result.hpp"
 #include "callback_holder.hpp"
+#include "checkpoint.hpp"
 #include "contract_base.hpp"
+#include "dependency_graph.hpp"
+#include "epoch.hpp"
 #include "factory_base.hpp"
+#include "flat_map.hpp"
 #include "might_shared_mutex.hpp"
 #include "not_registred_exception.hpp"
+#include "object_slot.hpp"
 #include "priorities.hpp"
 #include "type_already_registred_exception.hpp"
 #include "typed_contract.hpp"
 #include "utils.hpp"
 #include "id_holder.hpp"
+#include "index.hpp"
+#include "lifecycle.hpp"
+#include "string_view_polyfil.hpp"
+#include "teardown.hpp"
+#include "type_id.hpp"
 
 namespace iws {
 namespace reactor {
 
 namespace pf = ::iws::polyfil;
 
+template<typename T>
+class lazy_proxy;
+template<typename T>
+class service_handle;
+class static_factory_table;
+
 /**
  * @brief Manages singleton objects referenced with interfaces and names.
  *
@@ -58,8 +82,17 @@ class reactor
 {
  public:
    typedef std::vector<contract_base *> contract_list;
+   typedef std::function<void(std::function<void()>)> executor; // Runs the given task, possibly on an other thread
 
-   reactor();
+   /**
+    * @brief reactor constructor
+    * @param stage_registrations if true, registrations made before the first lookup are only queued and merged into
+    *          the registries in one pass by the first lookup. The global instance is constructed this way, so the
+    *          static init phase doesn't insert once per registrator. A factory conflicting with an other staged one
+    *          is still refused by its registration, only a conflict with a static table (see
+    *          register_static_factories()) is thrown by the first lookup.
+    */
+   explicit reactor(bool stage_registrations = false);
    ~reactor();
 
    /**
@@ -69,8 +102,7 @@ class reactor
     * @param priority of the registered factory. Factories with higher priority override ones with lower.
     * @param factory is the factory to be registered
     */
-   void register_factory(
-         const std::string &instance, priorities priority, const std::shared_ptr<factory_base> &factory);
+   void register_factory(pf::string_view instance, priorities priority, const std::shared_ptr<factory_base> &factory);
 
    /**
     * @brief unregister an alrady registered factory
@@ -79,7 +111,25 @@ class reactor
     * @param priority should be the same value which is used to register the factory need to be unregistered.
     * @param type should match the value that the factory -which need to be unregistered- returns through get_type().
     */
-   void unregister_factory(const std::string &instance, priorities priority, const std::type_info &type);
+   void unregister_factory(pf::string_view instance, priorities priority, const std::type_info &type);
+
+   /**
+    * @brief unregister the given factory if it is the one registered
+    *
+    * Used by the registrators, a registration which lost against an other one leaves the winner registered.
+    * @param instance should be the same value which is used to register the factory.
+    * @param priority should be the same value which is used to register the factory.
+    * @param factory is the registered factory, nothing happens if an other one is registered with these parameters.
+    */
+   void unregister_factory(pf::string_view instance, priorities priority, const std::shared_ptr<factory_base> &factory);
+
+   /**
+    * @brief queue a table of constant initialized factories (see static_factory.hpp)
+    *
+    * Lock-free and allocation free, the table is merged into the registry by the next call that looks at it.
+    * @throws std::logic_error if the reactor is frozen (see freeze())
+    */
+   void register_static_factories(static_factory_table &table);
 
    /**
     * @brief registers a new addon. More on addons: //TODO link to the addon chapter...
@@ -90,7 +140,7 @@ class reactor
     * @param addon rvalue reference to an unique_ptr containing the addon
     * @return a registration id as size_t that can be used to unregister the addon just registered.
     */
-   size_t register_addon(const std::string &instance, priorities priority, std::unique_ptr<addon_base> &&addon);
+   size_t register_addon(pf::string_view instance, priorities priority, std::unique_ptr<addon_base> &&addon);
 
    /**
     * @brief unregister all alrady registered addons for a given instance + type combination.
@@ -99,7 +149,7 @@ class reactor
     * @param type should match the value that the addons -which need to be unregistered- returns through get_type().
     * @return the number of unregistered addons as size_t
     */
-   size_t unregister_addons(const std::string &instance, const std::type_info &type);
+   size_t unregister_addons(pf::string_view instance, const std::type_info &type);
 
    /**
     * @brief unregister all alrady registered addons for a given instance + priority + type combination.
@@ -109,7 +159,7 @@ class reactor
     * @param type should match the value that the addons -which need to be unregistered- returns through get_type().
     * @return the number of unregistered addons as size_t
     */
-   size_t unregister_addons(const std::string &instance, priorities priority, const std::type_info &type);
+   size_t unregister_addons(pf::string_view instance, priorities priority, const std::type_info &type);
 
    /**
     * @brief unregister an already registered addon
@@ -118,7 +168,7 @@ class reactor
     * @param type should match the value that the addon -which need to be unregistered- returns through get_type().
     * @param reg_id should match the registration id returned by register_addon when registering the addon.
     */
-   void unregister_addon(const std::string &instance, const std::type_info &type, size_t reg_id);
+   void unregister_addon(pf::string_view instance, const std::type_info &type, size_t reg_id);
 
    /**
     * @brief registers a new addon filter. More on addons: //TODO link to the addon chapter...
@@ -130,7 +180,7 @@ class reactor
     * @return a registration id as size_t that can be used to unregister the addon just registered.
     */
    size_t register_addon_filter(
-         const std::string &instance, priorities priority, std::unique_ptr<addon_filter_base> &&filter);
+         pf::string_view instance, priorities priority, std::unique_ptr<addon_filter_base> &&filter);
 
    /**
     * @brief unregister all alrady registered addon filters for a given instance + type combination.
@@ -140,7 +190,7 @@ class reactor
     *          get_type().
     * @return the number of unregistered addon filters as size_t
     */
-   size_t unregister_addon_filters(const std::string &instance, const std::type_info &type);
+   size_t unregister_addon_filters(pf::string_view instance, const std::type_info &type);
 
    /**
     * @brief unregister all alrady registered addon filters for a given instance + priority + type combination.
@@ -151,7 +201,7 @@ class reactor
     *          get_type().
     * @return the number of unregistered addon filters as size_t
     */
-   size_t unregister_addon_filters(const std::string &instance, priorities priority, const std::type_info &type);
+   size_t unregister_addon_filters(pf::string_view instance, priorities priority, const std::type_info &type);
 
    /**
     * @brief unregister an already registered addon filter
@@ -162,23 +212,281 @@ class reactor
     * @param reg_id should match the registration id returned by register_addon_filter when registering the
     *          addon filter.
     */
-   void unregister_addon_filter(const std::string &instance, const std::type_info &type, size_t reg_id);
+   void unregister_addon_filter(pf::string_view instance, const std::type_info &type, size_t reg_id);
 
 
    template<typename T>
    bool instance_exists(const typed_contract<T> &contract) const;
    template<typename T>
    T &get(const typed_contract<T> &contract);
+
+   /**
+    * @brief get (or create) the object of a contract if there is a factory for it
+    *
+    * Unlike get() a missing factory is not an error, so optional services can be probed without the cost of an
+    * exception. Misses are remembered in the contract until the next register_factory() call.
+    * @return nullptr if no factory is registered for the contract
+    */
+   template<typename T>
+   T *try_get(const typed_contract<T> &contract);
+   /**
+    * @brief get the object of a contract if it was already created, never constructs
+    * @return nullptr if the object does not exist
+    */
+   template<typename T>
+   T *get_if_exists(const typed_contract<T> &contract) const;
+
+   /**
+    * @brief check if the default instance of T exists, without a contract
+    */
+   template<typename T>
+   bool instance_exists() const;
+   /**
+    * @brief get (or create) the default instance of T, without a contract
+    *
+    * Resolves through a per type slot of the reactor, so a repeated call costs the same as get() with a contract.
+    * Factories are selected exactly like for a contract with an empty instance name, but as there is no contract,
+    * validate_contracts() can't check these dependencies.
+    */
+   template<typename T>
+   T &get();
+   /**
+    * @brief get the owning shared_ptr of an object created by this reactor
+    * @throws std::runtime_error if the object is not owned by the reactor
+    */
    template<typename T>
    std::shared_ptr<T> get_ptr(T &obj);
+   /**
+    * @brief get (or create) the object of a contract as a shared_ptr
+    */
+   template<typename T>
+   std::shared_ptr<T> get_shared(const typed_contract<T> &contract);
+
+   /**
+    * @brief get (or create) the object of a contract without blocking the caller
+    *
+    * An existing object is returned as a ready result right away, otherwise the construction runs on the async
+    * executor (see set_async_executor()). It shares the construction with any other get() of the same object.
+    */
+   template<typename T>
+   async_result<T> get_async(const typed_contract<T> &contract);
+   /**
+    * @brief set the executor running the constructions of get_async()
+    *
+    * By default the constructions run on worker threads of the reactor, a new one is only started when every worker
+    * is busy. They are joined when the reactor is destructed. An executor must run all its tasks before the reactor is
+    * destructed.
+    */
+   void set_async_executor(const executor &exec);
+
+   /**
+    * @brief get (or create) the object of a contract as a service_handle (see service_handle.hpp)
+    */
+   template<typename T>
+   service_handle<T> get_handle(const typed_contract<T> &contract);
+   /**
+    * @brief get a lazy_proxy of the object of a contract (see lazy_proxy.hpp), the object is not constructed yet
+    */
+   template<typename T>
+   lazy_proxy<T> get_lazy(const typed_contract<T> &contract);
+   /**
+    * @brief get (or create) the object of a contract like get(), unless it doesn't exist and its factory is lazy
+    *
+    * The factory is only looked up when the object doesn't exist, so resolving an existing object costs a get().
+    * @return nullptr if the object is left to its first use (see factory_base::set_lazy())
+    */
+   template<typename T>
+   T *get_unless_lazy(const typed_contract<T> &contract);
+   /**
+    * @brief get (or create) the object of a contract for an object that took it lazily in its constructor
+    *
+    * Records the dependency like a get() of the dependent's constructor would have, and moves the dependent, with the
+    * objects depending on it, after the object in the creation order, so they are destructed before it. Nothing is
+    * recorded if the dependent doesn't exist (anymore).
+    */
+   template<typename T>
+   T &get_for(const typed_contract<T> &contract, const index &dependent);
+   /**
+    * @brief get the object the calling thread is constructing
+    * @return false if the thread is not running a constructor of this reactor
+    */
+   bool current_construction(index &result) const;
+   /**
+    * @brief resolve a handle issued by this reactor
+    * @return nullptr if the object was released by reset_objects() since
+    */
+   template<typename T>
+   T *resolve(const service_handle<T> &handle) const;
    void reset_objects();
+   /**
+    * @brief destruct the object of a contract and every object whose constructor got it, directly or transitively
+    *
+    * The objects are destructed in reverse creation order, every other object stays available to the readers.
+    * Constructions are held back for the time of the reset, like with reset_objects(). Started services among them
+    * are stopped first (see lifecycle). Dependencies not got by a constructor are not known.
+    */
+   void reset(const contract_base &contract);
+   /**
+    * @brief rebuild the objects in the background, then replace the current ones with them in one step
+    *
+    * The objects existing at the call are constructed again, in their creation order, by a task given to the async
+    * executor (see set_async_executor()). Their constructors only see the objects of the new generation, while every
+    * other thread keeps using the current ones. Once everything is built get() is switched over, the services of the
+    * old generation are stopped and the objects are destructed after the readers left them. The new services are
+    * not started, call start_services() when the result is ready.
+    * @return becomes ready after the switch, holds the exception of a failed constructor, in which case the current
+    *         objects are kept
+    */
+   std::shared_future<void> reset_objects_async();
+   /**
+    * @brief record the objects existing right now, to return to them later with restore()
+    */
+   object_checkpoint checkpoint();
+   /**
+    * @brief return to the objects of a checkpoint without rebuilding the ones that are still valid
+    *
+    * Destructs the objects created since the checkpoint, the ones whose factory would be selected differently now
+    * (like after registering a factory with a higher priority) and every object whose constructor got one of these,
+    * in reverse creation order, like reset(). Then the objects of the checkpoint that are missing are constructed
+    * again, in their original order, from the factories registered now. Services constructed again are not started.
+    * @throws std::invalid_argument if the checkpoint was taken by an other reactor
+    */
+   void restore(const object_checkpoint &cp);
+   /**
+    * @brief set how reset_objects() and the destructor destruct the objects (see teardown_options)
+    */
+   void set_teardown_options(const teardown_options &options);
+   /**
+    * @brief wait until the reaper destructed every object handed to it (see teardown_options::deferred)
+    * @throws std::logic_error if called by a destructor running on the reaper
+    */
+   void drain();
+
+   /**
+    * @brief create the objects of every registered factory up front, in parallel, except the lazy ones
+    *        (see factory_base::set_lazy())
+    *
+    * Up to concurrency workers take the registered indexes one by one; the dependencies a constructor gets are built
+    * inline by its worker or waited for when an other worker is already building them, so independent objects are
+    * constructed concurrently. Objects are recorded in order of completion, so reset_objects() still destructs
+    * dependents before their dependencies. The calling thread is one of the workers, the others are passed to
+    * the executor. Returns when all workers are done.
+    * @throws the first exception thrown by a constructor, after every other object was attempted
+    */
+   void instantiate_all(const executor &exec, size_t concurrency);
+   /**
+    * @brief instantiate_all() on threads started for the call
+    * @param concurrency number of threads including the calling one, 0 means std::thread::hardware_concurrency()
+    */
+   void instantiate_all(size_t concurrency = 0);
 
+   /**
+    * @brief call start() on the existing objects implementing lifecycle (see lifecycle.hpp) that weren't started yet
+    *
+    * Objects are started in waves taken from the dependency graph, an object is only started once everything its
+    * constructor got is started. The objects of one wave are started in parallel by up to concurrency workers, like
+    * instantiate_all() does, no reactor lock is held while start() runs.
+    * @throws the first exception thrown by start(), after the current wave finished; later waves are not started
+    */
+   void start_services(const executor &exec, size_t concurrency);
+   /**
+    * @brief start_services() on threads started for the call
+    * @param concurrency number of threads including the calling one, 0 means std::thread::hardware_concurrency()
+    */
+   void start_services(size_t concurrency = 0);
+   /**
+    * @brief check if the object of a contract exists and is started, objects not implementing lifecycle are ready
+    *        as soon as they are constructed
+    */
    template<typename T>
-   typename addon_func_map<T>::type get_addons(const std::string &instance = std::string()) const;
+   bool is_ready(const typed_contract<T> &contract) const;
+   /**
+    * @brief check if the factory selected for a contract is lazy (see factory_base::set_lazy())
+    * @return false if there is no factory for it
+    */
+   bool is_lazy(const contract_base &contract);
+
+   /**
+    * @brief order the registered factories by their declared dependencies (see depends_on), without constructing
+    *
+    * Every level only depends on the levels before it, so the objects of one level can be constructed in parallel.
+    * Dependencies without a registered factory are left out.
+    * @throws std::runtime_error if the declared dependencies contain a cycle
+    */
+   std::vector<std::vector<index>> build_plan() const;
+
+   /**
+    * @brief write the objects created since the last reset_objects() to a file, in order of creation
+    *
+    * One line per object with its construction time, type and instance name; replayed by prewarm_from().
+    * @throws std::runtime_error if the file can't be written
+    */
+   void save_profile(const std::string &path) const;
+   /**
+    * @brief save_profile() into the given file when the reactor is destructed, empty path disables it
+    */
+   void set_profile_path(const std::string &path);
+   /**
+    * @brief construct the objects listed in a profile written by save_profile() on background threads
+    *
+    * The objects are taken in the recorded order by up to concurrency workers, like instantiate_all() does. Entries
+    * without a registered factory are skipped, a missing file is not an error (there is nothing to replay on the
+    * first start). The reactor joins the workers when destructed.
+    * @return becomes ready when every listed object was attempted, holds the first exception of the constructors
+    * @throws std::runtime_error if the file is not a profile
+    */
+   std::shared_future<void> prewarm_from(const std::string &path, size_t concurrency = 1);
 
+   /**
+    * @brief get the addons registered for an instance
+    *
+    * The name is only looked up, so probing with names that were never registered does not grow the name registry.
+    */
+   template<typename T>
+   typename addon_func_map<T>::type get_addons(pf::string_view instance = pf::string_view()) const;
+
+   /**
+    * @brief seal the registries
+    *
+    * From now on register_* calls throw std::logic_error, while get(), get_addons() and instance_exists() read an
+    * immutable copy of the registries without taking any lock. Unregistering anything (like registrators going out of
+    * scope at shutdown) thaws the reactor first, so it keeps working from destructors.
+    */
+   void freeze();
+   /**
+    * @brief accept registrations again after freeze(), mostly for tests
+    */
+   void thaw();
+   bool is_frozen() const;
+
+   /**
+    * @brief the objects constructed since the last reset_objects() and the objects their constructors got
+    *
+    * Every get() a constructor makes on its own thread is recorded as an edge, including the ones that found an
+    * existing object: only the constructing thread skips the contract cache, every other thread keeps using it. Objects
+    * a constructor has got on other threads (tasks it started, get_async()) are not recorded. Lazy pulleys and proxies
+    * are recorded when they first resolve (see get_for()).
+    */
+   dependency_graph get_dependency_graph() const;
+
+   /**
+    * @brief called before and after objects are destructed by reset_objects(), reset(), restore() and
+    *        reset_objects_async(), observers caching pointers to objects must drop them on the first one
+    *
+    * reset_objects_async() calls them from its background task, once get() returns the objects of the new generation.
+    * reset() and restore() call them even if only some of the objects are destructed.
+    */
    threadsafe_callback_holder<> sig_before_reset_objects;
    threadsafe_callback_holder<> sig_after_reset_objects;
+   /**
+    * @brief called after every teardown with the destructors exceeding teardown_options::slow_threshold, also from
+    *        the destructor of the reactor
+    */
+   threadsafe_callback_holder<const teardown_report &> sig_teardown_report;
 
+   /**
+    * @brief check that every contract has a factory and the declared dependencies (see depends_on) have no cycle
+    */
    bool validate_contracts() const;
    contract_list unsatisfied_contracts() const;
    void test_all_contracts() const;
@@ -192,41 +500,279 @@ class reactor
          priorities_map; // Must be shared_ptr so get() can safely
                          // release the factory read mutex while creating the object to avoid recursive locking of the
                          // shared mutex
-   typedef std::map<index, priorities_map> factory_map;
-   typedef std::map<index, std::shared_ptr<void>> object_map;
+   typedef flat_map<index, priorities_map> factory_map;
    typedef std::vector<std::shared_ptr<void>> object_list;
-   typedef std::vector<index> wip_list;
    typedef std::unique_ptr<addon_base> addon_ptr;
    typedef id_holder<size_t, addon_ptr> addon_holder;
    typedef std::multimap<priorities, addon_holder> addon_priority_map;
-   typedef std::map<index, addon_priority_map> addon_map;
+   typedef flat_map<index, addon_priority_map> addon_map;
    typedef std::unique_ptr<addon_filter_base> addon_filter_ptr;
    typedef id_holder<size_t, addon_filter_ptr> addon_filter_holder;
    typedef std::multimap<priorities, addon_filter_holder> addon_filter_priority_map;
-   typedef std::map<index, addon_filter_priority_map> addon_filter_map;
+   typedef flat_map<index, addon_filter_priority_map> addon_filter_map;
+
+   /**
+    * @brief Immutable view of the created objects
+    *
+    * Never modified after publishing, every change publishes a new copy and retires the old one into the epoch
+    * domain, so readers only need an acquire load and no lock. The objects are owned by _object_list.
+    * A copy only duplicates the objects added recently, the rest sits in a base shared by the snapshots. The recent
+    * ones are merged into a new base once they outgrow the square root of it, so creating n objects copies
+    * O(n * sqrt(n)) items instead of O(n^2), while a lookup stays at most two probes.
+    */
+   class object_snapshot
+   {
+    public:
+      void *find(const index &id) const;
+      bool empty() const { return _recent.empty() && (nullptr == _base || _base->empty()); }
+      object_snapshot *with(const index &id, void *obj) const;
+      object_snapshot *without(const std::vector<index> &ids) const;
+      /**
+       * @brief add an object, only for snapshots not published yet
+       */
+      void insert(const index &id, void *obj) { _recent.try_emplace(id, obj); }
+
+    private:
+      typedef flat_map<index, void *> item_map;
+
+      std::shared_ptr<const item_map> _base; // Never modified, may be null
+      item_map _recent;
+   };
+
+   /**
+    * @brief Immutable copy of the registries taken by freeze()
+    *
+    * Kept until the reactor is destructed, so a lookup that loaded it never has to synchronize with thaw(). Addons are
+    * owned by _addon_map, and just like the result of get_addons(), must not be unregistered while in use.
+    */
+   struct frozen_registry
+   {
+      typedef std::vector<std::pair<priorities, addon_base *>> addon_list; // In priority order
+      typedef std::vector<addon_filter_base *> addon_filter_list;          // In priority order
+
+      flat_map<index, std::shared_ptr<factory_base>> factories; // Only the highest priority one of each index
+      flat_map<index, addon_list> addons;
+      flat_map<index, addon_filter_list> addon_filters;
+   };
+
+   /**
+    * @brief An object being constructed, shared by the threads waiting for it
+    */
+   struct construction
+   {
+      std::thread::id owner;
+      bool done;
+      void *obj;
+      std::exception_ptr error;
+   };
+   typedef flat_map<index, std::shared_ptr<construction>> construction_map;
+   typedef std::vector<std::pair<index, std::shared_ptr<factory_base>>> construction_items;
+   typedef std::vector<std::function<void()>> task_list;
+
+   /**
+    * @brief Lifecycle state of a constructed object implementing lifecycle
+    */
+   struct service_state
+   {
+      lifecycle *obj;
+      bool started;
+   };
+   typedef std::vector<std::vector<std::pair<index, lifecycle *>>> service_waves;
+
+   class teardown_run;
+
+   /**
+    * @brief Objects detached from the reactor by reset_objects(), in creation order
+    */
+   struct teardown_batch
+   {
+      object_list objects;
+      std::vector<index> ids;  // Of the objects, in the same order
+      dependency_graph graph;  // Only used by parallel teardowns
+      teardown_options options;
+   };
+
+   /**
+    * @brief The next generation built by reset_objects_async(), only touched by the thread building it
+    */
+   struct shadow_generation
+   {
+      object_snapshot snapshot;
+      object_list objects;
+      std::vector<std::pair<index, std::chrono::nanoseconds>> creation_order;
+      dependency_graph graph;
+      flat_map<index, service_state> services;
+   };
+
+   /**
+    * @brief A registration queued before the first lookup, exactly one of factory, addon and filter is set
+    */
+   struct staged_registration
+   {
+      staged_registration(const index &registration_id, priorities registration_priority)
+            : id(registration_id)
+            , priority(registration_priority)
+            , reg_id(0)
+            , next(nullptr)
+      {
+      }
+
+      index id;
+      priorities priority;
+      std::shared_ptr<factory_base> factory;
+      std::unique_ptr<addon_base> addon;
+      std::unique_ptr<addon_filter_base> filter;
+      size_t reg_id;
+      staged_registration *next;
+   };
 
    factory_map _factory_map;
-   object_map _object_map;
-   object_list _object_list;
-   wip_list _wip_list;
+   std::atomic<const object_snapshot *> _object_snapshot; // Replaced only while holding _object_list_mutex
+   object_list _object_list; // In order of completion, so dependencies always precede their dependents
+   std::vector<std::pair<index, std::chrono::nanoseconds>> _creation_order; // Same order, with construction times
+   std::string _profile_path; // Protected by _object_list_mutex
+   std::vector<std::thread> _background_threads; // Workers of prewarming and async gets, joined by the destructor
+   std::deque<std::function<void()>> _background_tasks;
+   size_t _background_idle;   // Workers waiting for a task
+   bool _background_stopping; // Set by the destructor, workers leave once the queue is empty
+   executor _async_executor;
+   std::mutex _background_mutex; // Protects the workers, their queue and _async_executor
+   std::condition_variable _background_cv;
+   flat_map<const void *, size_t> _object_owners; // Object address -> position in _object_list
+
+   /**
+    * @brief Slot of the service_handle table, gets a process unique generation every time it is issued, 0 once released
+    */
+   struct handle_entry
+   {
+      std::atomic<uint32_t> generation;
+      std::atomic<void *> obj;
+   };
+   static const size_t handle_chunk_size = 1024;
+   static const size_t handle_chunk_count = 256;
+   std::atomic<handle_entry *> _handle_chunks[handle_chunk_count]; // Allocated on demand, never move
+   flat_map<const void *, uint32_t> _object_handles;                // Object address -> slot
+   std::vector<uint32_t> _free_handles;
+   uint32_t _next_handle; // These three are protected by _object_owner_mutex
+   construction_map _constructions;
+   flat_map<std::thread::id, std::shared_ptr<construction>> _construction_waits; // Used to detect wait cycles
+   unsigned _resets_pending;
+   std::thread::id _reset_thread;
    contract_list _contract_list;
    addon_map _addon_map;
    std::atomic_size_t _addon_id;
    addon_filter_map _addon_filter_map;
    std::atomic_size_t _addon_filter_id;
+   std::atomic<static_factory_table *> _static_tables; // Not merged into _factory_map yet, latest first
+   std::atomic<staged_registration *> _staged;          // Not merged into the registries yet, latest first
+   mutable std::atomic_bool _staging;                    // Registrations are staged until the first lookup
+   flat_map<index, std::vector<priorities>> _staged_factories; // Staged but not merged yet, to refuse conflicts early
+   std::mutex _staged_factories_mutex;
+   std::atomic<const frozen_registry *> _frozen; // nullptr unless frozen
+   std::vector<std::unique_ptr<frozen_registry>> _frozen_registries; // Modified only holding both registry locks
 
-   pf::might_shared_mutex _factory_mutex;
+   mutable pf::might_shared_mutex _factory_mutex;
    mutable pf::might_shared_mutex _addon_mutex;
-   mutable pf::might_shared_mutex _object_map_mutex;
-   std::recursive_mutex _object_list_mutex; // also protects wip_list
+   mutable std::recursive_mutex _object_list_mutex; // also protects publishing of _object_snapshot
+   mutable pf::might_shared_mutex _object_owner_mutex; // Modifying _object_list and _object_owners needs this too
+   std::mutex _construction_mutex;          // protects _constructions, _construction_waits and _resets_pending
+   std::condition_variable _construction_cv;
    std::recursive_mutex _reset_objects_mutex;
+   teardown_options _teardown_options; // Protected by _reset_objects_mutex
+   std::thread _reaper; // Started by the first deferred teardown
+   std::deque<teardown_batch> _reaper_queue;
+   bool _reaper_busy;
+   bool _reaper_stopping;
+   std::mutex _reaper_mutex; // Protects the queue and the flags of the reaper
+   std::condition_variable _reaper_cv;
    mutable std::mutex _contract_mutex;
 
    std::atomic_bool _shutting_down;
+   epoch_domain &_epoch_domain;
+   std::atomic<uint64_t> _generation; // Process wide unique, replaced by every reset_objects()
+   std::atomic<uint64_t> _factory_generation; // Process wide unique, replaced by every register_factory()
+   std::atomic<shadow_generation *> _shadow;  // Set while reset_objects_async() builds the next generation
+   dependency_graph _dependency_graph;
+   mutable std::mutex _dependency_graph_mutex;
+   flat_map<index, service_state> _services;
+   mutable std::mutex _services_mutex;  // Protects _services
+   std::mutex _service_lifecycle_mutex; // Serializes starting and stopping the services
+
+   // Slots of the contract-less get<T>(), indexed by type_id and allocated one chunk at a time so they never move
+   static const size_t type_slot_chunk_size = 256;
+   static const size_t type_slot_chunk_count = 256;
+   mutable std::atomic<object_slot *> _type_slots[type_slot_chunk_count];
+
+   template<typename T>
+   T &get(const index &id, object_slot *slot, uint64_t generation);
+   std::shared_ptr<factory_base> find_factory(const index &id);
+   std::shared_ptr<factory_base> select_factory(const std::type_info &type, const index &id);
+   void *create_object(const std::type_info &type, const index &id, const std::shared_ptr<factory_base> &factory);
+   void finish_construction(const index &id, construction &state, void *obj, std::exception_ptr error);
+   void record_dependency(const index &id);
+   void record_lazy_dependency(const index &dependent, const index &id);
+   std::vector<std::vector<index>> plan_levels(size_t &unplanned) const;
+   construction_items planned_items() const;
+   void construct_items(construction_items items, const executor &exec, size_t concurrency);
+   void construct_items_on_threads(construction_items items, size_t concurrency);
+   task_list make_construction_tasks(construction_items items);
+   static void run_tasks(task_list tasks, const executor &exec, size_t concurrency);
+   static void run_tasks_on_threads(task_list tasks, size_t concurrency);
+   void destruct_batch(teardown_batch &batch, teardown_run &run);
+   void queue_teardown(teardown_batch batch);
+   void reaper_loop();
+   void stop_reaper();
+   service_waves make_service_waves(bool started, const std::vector<index> *only = nullptr) const;
+   void start_waves(service_waves waves, const std::function<void(task_list)> &run);
+   void stop_services(const std::vector<index> *only = nullptr);
+   bool is_service_ready(const index &id) const;
+   void run_in_background(std::function<void()> task);
+   void run_on_worker(std::function<void()> task);
+   void background_loop();
+   void check_not_frozen() const;
+   void stage(std::unique_ptr<staged_registration> &&registration);
+   void unregister_factory(pf::string_view instance, priorities priority, const std::type_info &type,
+         const std::shared_ptr<factory_base> &factory);
+   void merge_pending_registrations() const;
+   void merge_pending_registrations_locked();
+   object_slot *type_slot(type_id::value_type id) const;
+   object_slot *create_type_slot_chunk(size_t chunk) const;
+   void *find_object(const index &id) const;
+   bool building_shadow() const;
+   bool is_shadow_builder() const;
+   void *find_shadow_object(const index &id) const;
+   void *create_shadow_object(
+         const std::type_info &type, const index &id, const std::shared_ptr<factory_base> &factory);
+   void swap_generation();
+   void reset_selected(const char *caller, const std::function<std::vector<index>()> &select);
+   std::vector<index> changed_since(const object_checkpoint &cp);
+   std::shared_ptr<void> find_owner(const void *obj) const;
+   void issue_handle(void *obj, uint32_t &slot, uint32_t &generation);
+   void *resolve_handle(uint32_t slot, uint32_t generation) const;
+   /**
+    * @brief hide every object from the readers, the caller has to synchronize the epoch domain before destructing
+    *        them if handles were released
+    * @return true if handles were released
+    */
+   bool hide_objects();
+   bool release_handles(); // Returns true if handles were released, see hide_objects()
+   void release_handle(uint32_t slot);
+   void publish_objects(const object_snapshot *snapshot);
+   static uint64_t next_generation();
+   /**
+    * @brief tell if the calling thread is running a constructor (of any reactor)
+    *
+    * Such a get() has to take the slow path to record the dependency, every other thread keeps using the cached
+    * objects. Not inline, the constructions are tracked in a thread local of the library.
+    */
+   static bool is_constructing_thread();
+   static uint32_t next_handle_generation();
 
    void register_contract(contract_base *cont);
    void unregister_contract(contract_base *cont);
    friend class contract_base;
+   template<typename T>
+   friend class lazy_proxy;
 };
 
 // ----
@@ -234,123 +780,316 @@ class reactor
 template<typename T>
 bool reactor::instance_exists(const typed_contract<T> &contract) const
 {
-   const index &id = contract.get_index();
+   return nullptr != find_object(contract.get_index());
+}
 
-   // Try to find an existing instance
-   pf::might_shared_lock<pf::might_shared_mutex> object_map_read_lock(_object_map_mutex);
-   auto oi = _object_map.find(id);
+template<typename T>
+T &reactor::get(const typed_contract<T> &contract)
+{
+   // Read the generation first, whatever we find after this can only be cached for this generation
+   const uint64_t generation = _generation.load(std::memory_order_acquire);
+   object_slot &slot = contract.get_slot();
+   void *cached = slot.get(generation);
+   if (nullptr != cached && !is_constructing_thread())
+   {
+      return *static_cast<T *>(cached);
+   }
 
-   return oi != _object_map.end();
+   return get<T>(contract.get_index(), &slot, generation);
 }
 
 template<typename T>
-T &reactor::get(const typed_contract<T> &contract)
+T *reactor::try_get(const typed_contract<T> &contract)
 {
-   const std::type_info &t = typeid(T);
-   const index &id = contract.get_index();
+   const uint64_t generation = _generation.load(std::memory_order_acquire);
+   object_slot &slot = contract.get_slot();
+   void *obj = slot.get(generation);
+   if (nullptr != obj && !is_constructing_thread())
+   {
+      return static_cast<T *>(obj);
+   }
 
-   // Try to find an existing instance
-   pf::might_shared_lock<pf::might_shared_mutex> object_map_read_lock(_object_map_mutex);
-   auto oi = _object_map.find(id);
-   if (oi != _object_map.end())
+   // Read before the lookups, so a factory registered meanwhile invalidates the miss we record. Without a factory
+   // registered since the miss, the object can't have been created either.
+   const uint64_t factory_generation = _factory_generation.load(std::memory_order_acquire);
+   if (slot.is_miss(factory_generation))
    {
-      return *static_cast<T *>(oi->second.get());
+      return nullptr;
    }
-   // Release the shared lock so we (or another thread) can acquire the unique lock on the object map after producing
-   // a new object
-   object_map_read_lock.unlock();
-
-   // The object has not yet been created, letcs look for it's factory
-   pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
-   auto fi = _factory_map.find(id);
-   if (fi == _factory_map.end())
-   {
-      // Look for the default factory if there isn't a named one
-      fi = _factory_map.find(index(t, std::string()));
-      if (fi == _factory_map.end())
+
+   const index &id = contract.get_index();
+   obj = find_object(id);
+   if (nullptr == obj)
+   {
+      auto factory = find_factory(id);
+      if (nullptr == factory)
       {
-         // No factory found for the given parameters
-         throw factory_not_registred_exception(t, id.second);
+         slot.set_miss(factory_generation);
+         return nullptr;
       }
+
+      obj = create_object(typeid(T), id, factory);
    }
 
-   // Get the factory with the highest priority
-   auto fii = fi->second.rbegin();
-   // No validity check here, register and unregister factory should make sure that the priority map always
-   // has at least one item
-   auto selected_factory = fii->second;
+   if (is_constructing_thread())
+   {
+      record_dependency(id);
+   }
 
-   // Unlock to avoid recursive locking of the shared mutex. The factory is held by a shared_ptr so it won't disappear
-   factory_read_lock.unlock();
+   if (!building_shadow())
+   {
+      slot.set(generation, obj);
+   }
+   return static_cast<T *>(obj);
+}
 
-   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
-   // Recheck if object were created since we've released the object read lock
-   // Objects are only created and added while the object_list is locked
-   oi = _object_map.find(id);
-   if (oi != _object_map.end())
+template<typename T>
+T *reactor::get_if_exists(const typed_contract<T> &contract) const
+{
+   void *obj = building_shadow() ? nullptr : contract.get_slot().get(_generation.load(std::memory_order_acquire));
+   if (nullptr == obj)
    {
-      return *static_cast<T *>(oi->second.get());
+      obj = find_object(contract.get_index());
    }
 
-   //
-   if (_wip_list.end() != std::find(_wip_list.begin(), _wip_list.end(), id))
+   return static_cast<T *>(obj);
+}
+
+template<typename T>
+async_result<T> reactor::get_async(const typed_contract<T> &contract)
+{
+   auto state = std::make_shared<detail::async_state>();
+
+   void *obj = get_if_exists(contract);
+   if (nullptr != obj)
    {
-      throw std::runtime_error("Recursive call to reactor.get() on the same object");
+      state->complete(obj, nullptr);
+      return async_result<T>(state);
    }
-   _wip_list.push_back(id);
 
-   try
+   // The contract doesn't have to outlive the task, so it resolves without its slot
+   const index id = contract.get_index();
+   run_in_background([this, state, id]() {
+      void *result = nullptr;
+      std::exception_ptr error;
+      try
+      {
+         result = &get<T>(id, nullptr, 0);
+      }
+      catch (...)
+      {
+         error = std::current_exception();
+      }
+      state->complete(result, error);
+   });
+
+   return async_result<T>(state);
+}
+
+template<typename T>
+T *reactor::get_unless_lazy(const typed_contract<T> &contract)
+{
+   if (nullptr == get_if_exists(contract) && is_lazy(contract))
    {
-      // Call the factory to produce the requested object
-      // Do this while only holding the recursive object list mutex so a constructor is able to recursively call get
-      // to acquire it's dependencies
-      auto obj = selected_factory->produce(id.second).get<T>();
+      return nullptr;
+   }
 
-      _wip_list.pop_back(); // No need to find, it has to be the back item :)
+   return &get(contract);
+}
 
-      // Also lock the map for actual insert
-      // Don't lock earlies so getters of other types can still work while creating the object, and to allow recursion
-      std::unique_lock<pf::might_shared_mutex> object_map_write_lock(_object_map_mutex);
-      // Store the constructed object
-      _object_map.insert(object_map::value_type(id, obj));
-      _object_list.push_back(obj);
+template<typename T>
+T &reactor::get_for(const typed_contract<T> &contract, const index &dependent)
+{
+   T &obj = get(contract);
+   record_lazy_dependency(dependent, contract.get_index());
+   return obj;
+}
 
-      return *static_cast<T *>(obj.get());
+template<typename T>
+bool reactor::is_ready(const typed_contract<T> &contract) const
+{
+   return is_service_ready(contract.get_index());
+}
+
+template<typename T>
+bool reactor::instance_exists() const
+{
+   object_slot *slot = type_slot(type_id::of<T>());
+   if (nullptr != slot && nullptr != slot->get(_generation.load(std::memory_order_acquire)))
+   {
+      return true;
    }
-   catch (...)
+
+   return nullptr != find_object(index(typeid(T)));
+}
+
+template<typename T>
+T &reactor::get()
+{
+   const uint64_t generation = _generation.load(std::memory_order_acquire);
+   object_slot *slot = type_slot(type_id::of<T>());
+   if (nullptr != slot)
    {
-      if (id == _wip_list.back()) // Crashed before popping the list..
+      void *cached = slot->get(generation);
+      if (nullptr != cached && !is_constructing_thread())
       {
-         _wip_list.pop_back(); // Just in case... ;)
+         return *static_cast<T *>(cached);
       }
-      throw;
    }
+
+   return get<T>(index(typeid(T)), slot, generation);
 }
 
 template<typename T>
-std::shared_ptr<T> reactor::get_ptr(T &obj)
+T &reactor::get(const index &id, object_slot *slot, uint64_t generation)
 {
-   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
-
    // Try to find an existing instance
-   auto oi = detail::find_if(_object_list, [&obj](const std::shared_ptr<void> &item) { return &obj == item.get(); });
+   void *obj = find_object(id);
+   if (nullptr == obj)
+   {
+      obj = create_object(typeid(T), id, select_factory(typeid(T), id));
+   }
+
+   if (is_constructing_thread())
+   {
+      record_dependency(id);
+   }
+
+   // If a reset happened in the meantime the generation doesn't match anymore, so the slot just won't hit. Objects of
+   // a shadow generation are not reachable in the current one
+   if (nullptr != slot && !building_shadow())
+   {
+      slot->set(generation, obj);
+   }
+
+   return *static_cast<T *>(obj);
+}
+
+inline void *reactor::object_snapshot::find(const index &id) const
+{
+   auto it = _recent.find(id);
+   if (it != _recent.end())
+   {
+      return it->second;
+   }
+
+   if (nullptr == _base)
+   {
+      return nullptr;
+   }
+   it = _base->find(id);
+   return it != _base->end() ? it->second : nullptr;
+}
+
+inline object_slot *reactor::type_slot(type_id::value_type id) const
+{
+   const size_t chunk = id / type_slot_chunk_size;
+   if (chunk >= type_slot_chunk_count)
+   {
+      return nullptr; // Out of slots, these types always take the lookup path
+   }
+
+   object_slot *slots = _type_slots[chunk].load(std::memory_order_acquire);
+   if (nullptr == slots)
+   {
+      slots = create_type_slot_chunk(chunk);
+   }
+
+   return &slots[id % type_slot_chunk_size];
+}
+
+inline void *reactor::resolve_handle(uint32_t slot, uint32_t generation) const
+{
+   const handle_entry *chunk = _handle_chunks[slot / handle_chunk_size].load(std::memory_order_acquire);
+   if (0 == generation || nullptr == chunk)
+   {
+      return nullptr;
+   }
+
+   const handle_entry &entry = chunk[slot % handle_chunk_size];
+   if (entry.generation.load(std::memory_order_acquire) != generation)
+   {
+      return nullptr;
+   }
+
+   void *obj = entry.obj.load(std::memory_order_acquire);
 
-   if (oi != _object_list.end())
+   // Make sure the slot was not released while we were reading it
+   return (entry.generation.load(std::memory_order_acquire) == generation) ? obj : nullptr;
+}
+
+inline bool reactor::building_shadow() const
+{
+   // Only one thread builds the shadow, the others only pay for this load
+   return nullptr != _shadow.load(std::memory_order_relaxed) && is_shadow_builder();
+}
+
+inline void *reactor::find_object(const index &id) const
+{
+   if (building_shadow())
    {
-      return std::static_pointer_cast<T>(*oi);
+      return find_shadow_object(id);
    }
 
-   throw std::runtime_error("Object not found");
+   epoch_guard guard(_epoch_domain);
+   return _object_snapshot.load(std::memory_order_acquire)->find(id);
 }
 
 template<typename T>
-typename addon_func_map<T>::type reactor::get_addons(const std::string &instance) const
+std::shared_ptr<T> reactor::get_ptr(T &obj)
 {
-   pf::might_shared_lock<pf::might_shared_mutex> addon_read_lock(_addon_mutex);
+   return std::static_pointer_cast<T>(find_owner(&obj));
+}
 
+template<typename T>
+std::shared_ptr<T> reactor::get_shared(const typed_contract<T> &contract)
+{
+   return std::static_pointer_cast<T>(find_owner(&get(contract)));
+}
+
+template<typename T>
+typename addon_func_map<T>::type reactor::get_addons(pf::string_view instance) const
+{
    typename addon_func_map<T>::type result;
 
-   auto it = _addon_map.find(index{typeid(T), instance});
+   index id(typeid(T));
+   if (!index::find(typeid(T), instance, id))
+   {
+      // The name was never interned, so nothing could be registered for it
+      return result;
+   }
+
+   const frozen_registry *frozen = _frozen.load(std::memory_order_acquire);
+   if (nullptr != frozen)
+   {
+      auto it = frozen->addons.find(id);
+      if (frozen->addons.end() == it)
+      {
+         return result;
+      }
+
+      for (auto &item : it->second)
+      {
+         result.insert({item.first, dynamic_cast<addon<T> *>(item.second)});
+      }
+
+      auto it_filter = frozen->addon_filters.find(id);
+      if (frozen->addon_filters.end() != it_filter)
+      {
+         for (auto *filter : it_filter->second)
+         {
+            dynamic_cast<addon_filter<T> *>(filter)->filter_func(result);
+         }
+      }
+
+      return result;
+   }
+
+   merge_pending_registrations();
+
+   pf::might_shared_lock<pf::might_shared_mutex> addon_read_lock(_addon_mutex);
+
+   auto it = _addon_map.find(id);
    if (_addon_map.end() == it)
    {
       return result;
@@ -361,7 +1100,7 @@ typename addon_func_map<T>::type reactor::get_addons(const std::string &instance
       result.insert({item.first, dynamic_cast<addon<T> *>(item.second.value.get())});
    }
 
-   auto it_filter = _addon_filter_map.find(index{typeid(T), instance});
+   auto it_filter = _addon_filter_map.find(id);
    if (_addon_filter_map.end() != it_filter)
    {
       for (auto &filter : it_filter->second)
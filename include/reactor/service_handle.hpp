@@ -0,0 +1,110 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_SERVICE_HANDLE_HPP__
+#define __IWS_REACTOR_SERVICE_HANDLE_HPP__
+
+#include <cstdint>
+#include <type_traits>
+
+#include "r.hpp"
+#include "reactor.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Weak, trivially copyable reference to an object of a reactor
+ *
+ * A slot index and a generation in 8 bytes, so passing it around never touches a reference count. Resolving checks
+ * the generation against the slot table of the reactor, and yields nullptr once the object was released by
+ * reset_objects(). The returned pointer stays valid until the next reset; to use it while an other thread may reset,
+ * resolve and use it inside an epoch_guard, reset_objects() waits for those before destructing the objects. Don't
+ * construct objects inside such a guard, the reset holds back constructions while it waits for the guard.
+ * The member functions resolve through the global reactor, use reactor::resolve() for other instances. Generations
+ * are unique for the whole process, so the handle of an other instance resolves to nullptr there.
+ */
+template<typename T>
+class service_handle
+{
+ public:
+   service_handle();
+
+   T *get() const;
+   T *operator->() const { return get(); }
+
+   /**
+    * @brief false for default constructed handles (says nothing about the object still being alive)
+    */
+   explicit operator bool() const { return 0 != _generation; }
+
+   bool operator==(const service_handle &other) const
+   {
+      return _slot == other._slot && _generation == other._generation;
+   }
+   bool operator!=(const service_handle &other) const { return !(*this == other); }
+
+ private:
+   service_handle(uint32_t slot, uint32_t generation);
+
+   uint32_t _slot;
+   uint32_t _generation; // 0 means no object
+
+   friend class reactor;
+};
+
+// ----
+
+template<typename T>
+service_handle<T>::service_handle()
+      : _slot(0)
+      , _generation(0)
+{
+}
+
+template<typename T>
+service_handle<T>::service_handle(uint32_t slot, uint32_t generation)
+      : _slot(slot)
+      , _generation(generation)
+{
+}
+
+template<typename T>
+T *service_handle<T>::get() const
+{
+   return r.resolve(*this);
+}
+
+template<typename T>
+service_handle<T> reactor::get_handle(const typed_contract<T> &contract)
+{
+   static_assert(std::is_trivially_copyable<service_handle<T>>::value && 8 == sizeof(service_handle<T>),
+         "service_handle must stay a plain 8 byte value");
+
+   uint32_t slot;
+   uint32_t generation;
+   issue_handle(&get(contract), slot, generation);
+   return service_handle<T>(slot, generation);
+}
+
+template<typename T>
+T *reactor::resolve(const service_handle<T> &handle) const
+{
+   return static_cast<T *>(resolve_handle(handle._slot, handle._generation));
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_SERVICE_HANDLE_HPP__
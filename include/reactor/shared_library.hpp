@@ -0,0 +1,55 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_SHARED_LIBRARY_HPP__
+#define __IWS_REACTOR_SHARED_LIBRARY_HPP__
+
+#include <string>
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Owns a shared library opened at runtime (dlopen / LoadLibrary), closed when destructed
+ */
+class shared_library
+{
+ public:
+   /**
+    * @brief open the library
+    * @throws std::runtime_error if the library can't be opened
+    */
+   explicit shared_library(const std::string &path);
+   ~shared_library();
+
+   shared_library(const shared_library &) = delete;
+   shared_library &operator=(const shared_library &) = delete;
+
+   /**
+    * @brief look up an exported symbol
+    * @throws std::runtime_error if the library doesn't export it
+    */
+   void *symbol(const std::string &name) const;
+   const std::string &get_path() const { return _path; }
+
+ private:
+   const std::string _path;
+   void *_handle;
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_SHARED_LIBRARY_HPP__
@@ -0,0 +1,111 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_STATIC_FACTORY_HPP__
+#define __IWS_REACTOR_STATIC_FACTORY_HPP__
+
+#include <cstddef>
+#include <memory>
+#include <typeinfo>
+
+#include "factory.hpp"
+#include "priorities.hpp"
+#include "r.hpp"
+#include "reactor.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Constant initialized description of a factory
+ *
+ * Holds nothing that needs a constructor to run, so tables of these are filled in by the compiler. The factory
+ * object itself is only made when the reactor consumes the table.
+ */
+struct static_factory
+{
+   const std::type_info *type;
+   const char *instance; // Empty for the default instance
+   priorities priority;
+   std::shared_ptr<factory_base> (*make)();
+};
+
+namespace detail {
+
+template<typename I, typename T, bool pass_name>
+std::shared_ptr<factory_base> make_static_factory()
+{
+   return std::make_shared<factory<I, T, pass_name>>();
+}
+
+} // namespace detail
+
+/**
+ * @brief describe a reactor::factory<I, T, pass_name> (without constructor arguments) for a static_factory_table
+ */
+template<typename I, typename T, bool pass_name = false>
+constexpr static_factory static_factory_of(priorities priority, const char *instance = "")
+{
+   return static_factory{&typeid(I), instance, priority, &detail::make_static_factory<I, T, pass_name>};
+}
+
+/**
+ * @brief registers a constant initialized table of factories
+ *
+ * The cheap alternative of a factory_registrator per service: its constructor only links the table into a lock-free
+ * list of the reactor, the factories are created and merged into the registry in one pass by the first lookup.
+ *    static constexpr static_factory factories[] = {
+ *       static_factory_of<i_example, example_impl>(prio_normal),
+ *       static_factory_of<i_other, other_impl>(prio_normal, "named"),
+ *    };
+ *    static static_factory_table registration(factories);
+ * Tables are never unregistered, and must outlive the reactor (static storage duration is fine). Registration
+ * conflicts are thrown as type_already_registred_exception by the call that consumes the table.
+ */
+class static_factory_table
+{
+ public:
+   template<size_t N>
+   explicit static_factory_table(const static_factory (&factories)[N], reactor &target = r);
+
+   static_factory_table(const static_factory_table &) = delete;
+   static_factory_table &operator=(const static_factory_table &) = delete;
+
+   const static_factory *begin() const { return _factories; }
+   const static_factory *end() const { return _factories + _count; }
+
+ private:
+   const static_factory *_factories;
+   size_t _count;
+   static_factory_table *_next; // Link in the pending list of the reactor
+
+   friend class reactor;
+};
+
+// ----
+
+template<size_t N>
+static_factory_table::static_factory_table(const static_factory (&factories)[N], reactor &target)
+      : _factories(factories)
+      , _count(N)
+      , _next(nullptr)
+{
+   target.register_static_factories(*this);
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_STATIC_FACTORY_HPP__
@@ -0,0 +1,113 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_STRING_VIEW_POLYFIL_HPP__
+#define __IWS_STRING_VIEW_POLYFIL_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if __cplusplus < 201703L // target < C++17
+
+namespace iws {
+namespace polyfil {
+
+/**
+ * @brief Minimal non-owning string reference, only what reactor needs from std::string_view
+ */
+class string_view
+{
+ public:
+   string_view()
+         : _data(nullptr)
+         , _size(0)
+   {
+   }
+
+   string_view(const char *str)
+         : _data(str)
+         , _size(str ? std::strlen(str) : 0)
+   {
+   }
+
+   string_view(const char *str, size_t size)
+         : _data(str)
+         , _size(size)
+   {
+   }
+
+   string_view(const std::string &str)
+         : _data(str.data())
+         , _size(str.size())
+   {
+   }
+
+   const char *data() const { return _data; }
+   size_t size() const { return _size; }
+   bool empty() const { return 0 == _size; }
+
+   friend bool operator==(string_view lhs, string_view rhs)
+   {
+      return lhs._size == rhs._size && (0 == lhs._size || 0 == std::memcmp(lhs._data, rhs._data, lhs._size));
+   }
+
+   friend bool operator!=(string_view lhs, string_view rhs) { return !(lhs == rhs); }
+
+ private:
+   const char *_data;
+   size_t _size;
+};
+
+} // namespace polyfil
+} // namespace iws
+
+#else // target >= C++17
+#include <string_view>
+
+namespace iws {
+namespace polyfil {
+
+using std::string_view;
+
+} // namespace polyfil
+} // namespace iws
+
+#endif // target <> C++17
+
+namespace iws {
+namespace polyfil {
+
+/**
+ * @brief FNV-1a hash for string_view, so the same hashing is used with and without the polyfil
+ */
+struct string_view_hash
+{
+   size_t operator()(string_view str) const
+   {
+      uint64_t hash = 14695981039346656037ull;
+      for (size_t i = 0; i < str.size(); ++i)
+      {
+         hash ^= static_cast<unsigned char>(str.data()[i]);
+         hash *= 1099511628211ull;
+      }
+      return static_cast<size_t>(hash);
+   }
+};
+
+} // namespace polyfil
+} // namespace iws
+
+#endif // __IWS_STRING_VIEW_POLYFIL_HPP__
@@ -0,0 +1,95 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __IWS_REACTOR_TEARDOWN_HPP__
+#define __IWS_REACTOR_TEARDOWN_HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "index.hpp"
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief How reset_objects() (and the destructor of reactor) destructs the objects
+ */
+struct teardown_options
+{
+   teardown_options()
+         : concurrency(1)
+         , deadline(0)
+         , slow_threshold(std::chrono::milliseconds(100))
+         , deferred(false)
+   {
+   }
+
+   /**
+    * @brief number of threads destructing objects, 0 means std::thread::hardware_concurrency()
+    *
+    * Above 1 the objects are destructed in waves taken from the dependency graph: an object is only destructed once
+    * every object whose constructor got it is gone. Dependencies not got by a constructor are not known, objects
+    * using any should keep the default of 1 (reverse creation order on the calling thread).
+    */
+   size_t concurrency;
+   /**
+    * @brief time budget of the teardown in the destructor of the reactor, 0 means no limit
+    *
+    * Objects not destructed by then are abandoned: kept alive until the process exits, their destructors never run.
+    * reset_objects() and the reaper always destruct everything, an abandoned object could keep running on top of
+    * destructed dependencies or the next generation.
+    */
+   std::chrono::nanoseconds deadline;
+   /**
+    * @brief destructors running longer than this are listed in the teardown_report
+    */
+   std::chrono::nanoseconds slow_threshold;
+   /**
+    * @brief hand the released objects to a background reaper thread instead of destructing them in reset_objects()
+    *
+    * The reaper destructs one reset after the other, each like reset_objects() would, and publishes the reports from
+    * its own thread. Destructors run concurrently with the next generation, so they must not use the reactor.
+    * reactor::drain() waits for it, the destructor of the reactor always destructs synchronously.
+    */
+   bool deferred;
+};
+
+/**
+ * @brief Outcome of a teardown, see reactor::sig_teardown_report
+ */
+struct teardown_report
+{
+   struct slow_destructor
+   {
+      index id;
+      std::chrono::nanoseconds time;
+   };
+
+   teardown_report()
+         : total_time(0)
+   {
+   }
+
+   std::chrono::nanoseconds total_time;
+   std::vector<slow_destructor> slow_destructors; // In order of completion
+   std::vector<index> abandoned;                  // Left alive because the deadline passed, only at destruction
+};
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_TEARDOWN_HPP__
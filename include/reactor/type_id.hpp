@@ -0,0 +1,53 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __IWS_REACTOR_TYPE_ID_HPP__
+#define __IWS_REACTOR_TYPE_ID_HPP__
+
+#include <cstdint>
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Dense small integer ids for types, assigned at first use
+ *
+ * Only meant for indexing caches: a type used from multiple shared libraries may get more than one id (each module
+ * can have its own copy of the function local static), so the id must never be used to identify an object.
+ */
+class type_id
+{
+ public:
+   typedef uint32_t value_type;
+
+   template<typename T>
+   static value_type of();
+
+ private:
+   static value_type next();
+};
+
+// ----
+
+template<typename T>
+type_id::value_type type_id::of()
+{
+   static const value_type id = next();
+   return id;
+}
+
+} // namespace reactor
+} // namespace iws
+
+#endif //__IWS_REACTOR_TYPE_ID_HPP__
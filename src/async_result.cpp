@@ -0,0 +1,85 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <reactor/async_result.hpp>
+
+namespace iws {
+namespace reactor {
+namespace detail {
+
+async_state::async_state()
+      : _done(false)
+      , _obj(nullptr)
+{
+}
+
+void async_state::complete(void *obj, std::exception_ptr error)
+{
+   std::vector<std::function<void()>> continuations;
+   {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _obj = obj;
+      _error = error;
+      _done = true;
+      continuations.swap(_continuations);
+   }
+   _cv.notify_all();
+
+   // Outside of the lock, a resumed coroutine may well ask for an other object
+   for (auto &continuation : continuations)
+   {
+      continuation();
+   }
+}
+
+bool async_state::add_continuation(std::function<void()> continuation)
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+   if (_done)
+   {
+      return false;
+   }
+
+   _continuations.push_back(std::move(continuation));
+   return true;
+}
+
+bool async_state::is_ready() const
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+   return _done;
+}
+
+void async_state::wait() const
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+   _cv.wait(lock, [this] { return _done; });
+}
+
+void *async_state::get() const
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+   _cv.wait(lock, [this] { return _done; });
+
+   if (_error)
+   {
+      std::rethrow_exception(_error);
+   }
+   return _obj;
+}
+
+} // namespace detail
+} // namespace reactor
+} // namespace iws
@@ -0,0 +1,240 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <reactor/dependency_graph.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace iws {
+namespace reactor {
+
+namespace {
+
+void write_escaped(std::ostream &out, const std::string &text)
+{
+   static const char hex[] = "0123456789abcdef";
+
+   for (char c : text)
+   {
+      if ('"' == c || '\\' == c)
+      {
+         out << '\\' << c;
+      }
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+         out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+      }
+      else
+      {
+         out << c;
+      }
+   }
+}
+
+void write_label(std::ostream &out, const index &id)
+{
+   write_escaped(out, id.get_type().name());
+   if (!id.get_name().empty())
+   {
+      out << " '";
+      write_escaped(out, id.get_name());
+      out << "'";
+   }
+}
+
+} // namespace
+
+dependency_graph::node::node(const index &node_id)
+      : id(node_id)
+      , construction_time(0)
+{
+}
+
+const dependency_graph::node *dependency_graph::find(const index &id) const
+{
+   auto it = _positions.find(id);
+   return it != _positions.end() ? &_nodes[it->second] : nullptr;
+}
+
+std::string dependency_graph::to_dot() const
+{
+   std::ostringstream out;
+
+   out << "digraph reactor {\n";
+   for (size_t i = 0; i < _nodes.size(); ++i)
+   {
+      out << "   n" << i << " [label=\"";
+      write_label(out, _nodes[i].id);
+      out << "\\n" << std::chrono::duration_cast<std::chrono::microseconds>(_nodes[i].construction_time).count()
+          << " us\"];\n";
+   }
+   for (size_t i = 0; i < _nodes.size(); ++i)
+   {
+      for (auto &dependency : _nodes[i].dependencies)
+      {
+         out << "   n" << i << " -> n" << _positions.find(dependency)->second << ";\n";
+      }
+   }
+   out << "}\n";
+
+   return out.str();
+}
+
+std::string dependency_graph::to_json() const
+{
+   std::ostringstream out;
+
+   out << "{\"nodes\":[";
+   for (size_t i = 0; i < _nodes.size(); ++i)
+   {
+      auto &item = _nodes[i];
+
+      out << (0 == i ? "" : ",") << "{\"type\":\"";
+      write_escaped(out, item.id.get_type().name());
+      out << "\",\"instance\":\"";
+      write_escaped(out, item.id.get_name());
+      out << "\",\"construction_time_ns\":" << item.construction_time.count() << ",\"dependencies\":[";
+      for (size_t d = 0; d < item.dependencies.size(); ++d)
+      {
+         out << (0 == d ? "" : ",") << _positions.find(item.dependencies[d])->second;
+      }
+      out << "]}";
+   }
+   out << "]}";
+
+   return out.str();
+}
+
+std::vector<index> dependency_graph::collect_dependents(const index &id) const
+{
+   return collect_dependents(std::vector<index>(1, id));
+}
+
+std::vector<index> dependency_graph::collect_dependents(const std::vector<index> &ids) const
+{
+   std::vector<index> result;
+   flat_map<index, bool> visited;
+   for (auto &id : ids)
+   {
+      if (visited.try_emplace(id, true).second)
+      {
+         result.push_back(id);
+      }
+   }
+
+   // Breadth first along the reverse edges, result doubles as the queue
+   for (size_t next = 0; next < result.size(); ++next)
+   {
+      auto it = _dependents.find(result[next]);
+      if (it == _dependents.end())
+      {
+         continue;
+      }
+
+      for (auto &dependent : it->second)
+      {
+         if (visited.try_emplace(dependent, true).second)
+         {
+            result.push_back(dependent);
+         }
+      }
+   }
+
+   return result;
+}
+
+void dependency_graph::add_dependency(const index &dependent, const index &dependency)
+{
+   get_node(dependency);
+
+   auto &dependencies = get_node(dependent).dependencies;
+   if (dependencies.end() == std::find(dependencies.begin(), dependencies.end(), dependency))
+   {
+      dependencies.push_back(dependency);
+      _dependents[dependency].push_back(dependent);
+   }
+}
+
+void dependency_graph::set_construction_time(const index &id, std::chrono::nanoseconds time)
+{
+   get_node(id).construction_time = time;
+}
+
+void dependency_graph::remove(const std::vector<index> &ids)
+{
+   flat_map<index, bool> removed;
+   for (auto &id : ids)
+   {
+      if (_positions.end() != _positions.find(id))
+      {
+         removed.try_emplace(id, true);
+      }
+   }
+   if (removed.empty())
+   {
+      return;
+   }
+
+   auto is_removed = [&removed](const index &id) { return removed.end() != removed.find(id); };
+
+   node_list nodes;
+   nodes.reserve(_nodes.size() - removed.size());
+   for (auto &item : _nodes)
+   {
+      if (!is_removed(item.id))
+      {
+         auto &dependencies = item.dependencies;
+         dependencies.erase(std::remove_if(dependencies.begin(), dependencies.end(), is_removed), dependencies.end());
+         nodes.push_back(std::move(item));
+      }
+   }
+   _nodes.swap(nodes);
+
+   // Positions changed, rebuild the indexes from the remaining edges
+   _positions.clear();
+   _dependents.clear();
+   for (size_t i = 0; i < _nodes.size(); ++i)
+   {
+      _positions.try_emplace(_nodes[i].id, i);
+      for (auto &dependency : _nodes[i].dependencies)
+      {
+         _dependents[dependency].push_back(_nodes[i].id);
+      }
+   }
+}
+
+void dependency_graph::clear()
+{
+   _nodes.clear();
+   _positions.clear();
+   _dependents.clear();
+}
+
+dependency_graph::node &dependency_graph::get_node(const index &id)
+{
+   auto it = _positions.find(id);
+   if (it != _positions.end())
+   {
+      return _nodes[it->second];
+   }
+
+   _positions.try_emplace(id, _nodes.size());
+   _nodes.emplace_back(id);
+   return _nodes.back();
+}
+
+} // namespace reactor
+} // namespace iws
@@ -0,0 +1,178 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <reactor/epoch.hpp>
+
+#include <limits>
+#include <thread>
+
+namespace iws {
+namespace reactor {
+
+/**
+ * @brief Hands the participant record of an exiting thread back to the domain
+ */
+struct participant_releaser
+{
+   epoch_domain::participant *p;
+
+   participant_releaser()
+         : p(nullptr)
+   {
+   }
+
+   ~participant_releaser()
+   {
+      if (nullptr != p)
+      {
+         epoch_domain::instance().release_participant(*p);
+      }
+   }
+};
+
+static thread_local participant_releaser releaser;
+
+epoch_domain &epoch_domain::instance()
+{
+   // Leaked on purpose, readers may still enter from the static deinit phase and from detached threads
+   static epoch_domain *inst = new epoch_domain();
+   return *inst;
+}
+
+epoch_domain::epoch_domain()
+      : _global_epoch(1)
+      , _participants(nullptr)
+{
+}
+
+epoch_domain::participant &epoch_domain::acquire_participant()
+{
+   // Reuse a record released by an exited thread if there is one
+   for (participant *p = _participants.load(std::memory_order_acquire); nullptr != p; p = p->next)
+   {
+      bool expected = false;
+      if (!p->in_use.load(std::memory_order_relaxed) &&
+            p->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+      {
+         releaser.p = p;
+         return *p;
+      }
+   }
+
+   // Records are never freed, so the list can be walked without locking
+   participant *p = new participant();
+   p->epoch.store(0, std::memory_order_relaxed);
+   p->depth = 0;
+   p->in_use.store(true, std::memory_order_relaxed);
+   p->next = _participants.load(std::memory_order_relaxed);
+   while (!_participants.compare_exchange_weak(p->next, p, std::memory_order_release, std::memory_order_relaxed))
+   {
+   }
+
+   releaser.p = p;
+   return *p;
+}
+
+void epoch_domain::release_participant(participant &p)
+{
+   p.depth = 0;
+   p.epoch.store(0, std::memory_order_release);
+   p.in_use.store(false, std::memory_order_release);
+}
+
+uint64_t epoch_domain::min_active_epoch()
+{
+   // Pairs with enter(), the sanitizer build relies on the increment of the global epoch made by the caller
+#ifndef REACTOR_EPOCH_TSAN
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+
+   uint64_t result = std::numeric_limits<uint64_t>::max();
+   for (participant *p = _participants.load(std::memory_order_acquire); nullptr != p; p = p->next)
+   {
+      const uint64_t epoch = p->epoch.load(std::memory_order_acquire);
+      if (0 != epoch && epoch < result)
+      {
+         result = epoch;
+      }
+   }
+
+   return result;
+}
+
+void epoch_domain::retire(void *ptr, deleter del)
+{
+   std::vector<retired> reclaimable;
+
+   {
+      std::unique_lock<std::mutex> retired_lock(_retired_mutex);
+
+      // Readers entering from now on get a newer epoch, so they can not see ptr anymore
+      _retired.push_back(retired{_global_epoch.fetch_add(1, std::memory_order_acq_rel), ptr, del});
+
+      const uint64_t min_active = min_active_epoch();
+      auto it = _retired.begin();
+      while (it != _retired.end())
+      {
+         if (it->epoch < min_active)
+         {
+            reclaimable.push_back(*it);
+            it = _retired.erase(it);
+         }
+         else
+         {
+            ++it;
+         }
+      }
+   }
+
+   // Delete outside of the lock, deleters may retire further objects
+   for (auto &item : reclaimable)
+   {
+      item.del(item.ptr);
+   }
+}
+
+void epoch_domain::synchronize()
+{
+   // Readers entering from now on get a newer epoch, they can't see anything unpublished before this call
+   const uint64_t target = _global_epoch.fetch_add(1, std::memory_order_acq_rel);
+   const participant *self = &local();
+
+   // Pairs with enter(), like in min_active_epoch()
+#ifndef REACTOR_EPOCH_TSAN
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+
+   for (participant *p = _participants.load(std::memory_order_acquire); nullptr != p; p = p->next)
+   {
+      if (self == p)
+      {
+         continue;
+      }
+
+      for (;;)
+      {
+         const uint64_t epoch = p->epoch.load(std::memory_order_acquire);
+         if (0 == epoch || epoch > target)
+         {
+            break;
+         }
+         std::this_thread::yield();
+      }
+   }
+}
+
+} // namespace reactor
+} // namespace iws
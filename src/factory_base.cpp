@@ -19,6 +19,7 @@ namespace reactor {
 
 factory_base::factory_base(const std::type_info &type)
       : _type(type)
+      , _lazy(false)
 {
 }
 
@@ -29,5 +30,25 @@ const std::type_info &factory_base::get_type() const
    return _type;
 }
 
+const factory_base::dependency_list &factory_base::get_dependencies() const
+{
+   return _dependencies;
+}
+
+void factory_base::set_dependencies(const dependency_list &dependencies)
+{
+   _dependencies = dependencies;
+}
+
+bool factory_base::is_lazy() const
+{
+   return _lazy;
+}
+
+void factory_base::set_lazy(bool lazy)
+{
+   _lazy = lazy;
+}
+
 } // namespace reactor
 } // namespace iws
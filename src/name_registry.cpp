@@ -0,0 +1,100 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <reactor/name_registry.hpp>
+
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace iws {
+namespace reactor {
+
+name_registry &name_registry::instance()
+{
+   // Leaked on purpose, contracts and registrators may still use their indexes in the static deinit phase
+   static name_registry *inst = new name_registry();
+   return *inst;
+}
+
+name_registry::name_registry()
+{
+   _names.push_back(std::string());
+   _empty = &_names.back();
+   _ids.insert({pf::string_view(*_empty), 0});
+}
+
+name_registry::entry name_registry::empty()
+{
+   return entry{0, instance()._empty};
+}
+
+name_registry::entry name_registry::intern(pf::string_view name)
+{
+   if (name.empty())
+   {
+      return empty();
+   }
+
+   entry result;
+   if (find(name, result))
+   {
+      return result;
+   }
+
+   std::unique_lock<pf::might_shared_mutex> write_lock(_mutex);
+
+   // Recheck, an other thread might have added it since we've released the read lock
+   auto it = _ids.find(name);
+   if (it != _ids.end())
+   {
+      return entry{it->second, &_names[it->second]};
+   }
+
+   if (_names.size() > std::numeric_limits<id_type>::max())
+   {
+      throw std::length_error("Too many instance names interned");
+   }
+
+   const id_type id = static_cast<id_type>(_names.size());
+   _names.push_back(std::string(name.data(), name.size()));
+   const std::string &stored = _names.back();
+   // The key views the stored copy, not the callers buffer
+   _ids.insert({pf::string_view(stored.data(), stored.size()), id});
+
+   return entry{id, &stored};
+}
+
+bool name_registry::find(pf::string_view name, entry &result) const
+{
+   if (name.empty())
+   {
+      result = empty();
+      return true;
+   }
+
+   pf::might_shared_lock<pf::might_shared_mutex> read_lock(_mutex);
+
+   auto it = _ids.find(name);
+   if (it == _ids.end())
+   {
+      return false;
+   }
+
+   result = entry{it->second, &_names[it->second]};
+   return true;
+}
+
+} // namespace reactor
+} // namespace iws
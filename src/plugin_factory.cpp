@@ -0,0 +1,67 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <reactor/plugin_factory.hpp>
+
+#include <stdexcept>
+
+namespace iws {
+namespace reactor {
+
+plugin_factory::plugin_factory(const std::type_info &type, const std::string &path, const std::string &symbol)
+      : factory_base(type)
+      , _path(path)
+      , _symbol(symbol)
+{
+}
+
+factory_result plugin_factory::produce(const std::string &instance) const
+{
+   std::shared_ptr<loaded_plugin> plugin = load();
+
+   std::unique_ptr<factory_result> result;
+   plugin->entry(instance, result);
+   if (nullptr == result)
+   {
+      throw std::runtime_error("Plugin " + _path + " produced no object");
+   }
+
+   result->retain(std::move(plugin));
+   return *result;
+}
+
+bool plugin_factory::is_loaded() const
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+   return !_plugin.expired();
+}
+
+std::shared_ptr<plugin_factory::loaded_plugin> plugin_factory::load() const
+{
+   std::unique_lock<std::mutex> lock(_mutex);
+
+   std::shared_ptr<loaded_plugin> plugin = _plugin.lock();
+   if (nullptr == plugin)
+   {
+      plugin = std::make_shared<loaded_plugin>(_path);
+      plugin->entry = reinterpret_cast<entry_point>(plugin->library.symbol(_symbol));
+      _plugin = plugin;
+   }
+
+   return plugin;
+}
+
+} // namespace reactor
+} // namespace iws
@@ -32,8 +32,8 @@ init::init()
    if (1 != ++instance_count)
       return;
 
-   // Placement new for the global instance
-   new (&r) reactor();
+   // Placement new for the global instance, the registrators of the static init phase are only queued
+   new (&r) reactor(true);
 }
 
 init::~init()
@@ -14,32 +14,414 @@
 
 #include <reactor/reactor.hpp>
 
+#include <reactor/make_unique_polyfil.hpp>
+#include <reactor/static_factory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
 namespace iws {
 namespace reactor {
 
 static const std::string REACTOR_VERSION = MACRO_STR(PROJECT_VERSION);
 
-reactor::reactor()
-      : _shutting_down(false)
+namespace {
+
+const char *const profile_header = "reactor profile 1";
+
+// Profile lines are tab separated, so tabs, line breaks and the escape character itself are escaped
+void write_profile_field(std::ostream &out, const std::string &field)
+{
+   for (char c : field)
+   {
+      switch (c)
+      {
+         case '\\':
+            out << "\\\\";
+            break;
+         case '\t':
+            out << "\\t";
+            break;
+         case '\n':
+            out << "\\n";
+            break;
+         default:
+            out << c;
+      }
+   }
+}
+
+std::vector<std::string> read_profile_fields(const std::string &line)
+{
+   std::vector<std::string> fields(1);
+   for (size_t i = 0; i < line.size(); ++i)
+   {
+      if ('\t' == line[i])
+      {
+         fields.emplace_back();
+      }
+      else if ('\\' == line[i] && i + 1 < line.size())
+      {
+         ++i;
+         fields.back() += ('t' == line[i]) ? '\t' : ('n' == line[i]) ? '\n' : line[i];
+      }
+      else
+      {
+         fields.back() += line[i];
+      }
+   }
+   return fields;
+}
+
+struct construction_frame
+{
+   const reactor *owner;
+   const index *id;
+   const construction_frame *outer;
+};
+
+// The objects being constructed by the current thread, innermost first. The frames live on the stack of the
+// constructing calls; a plain pointer needs no thread exit destructor, so it is safe to use in the static deinit phase.
+thread_local const construction_frame *construction_stack = nullptr;
+
+const index *innermost_construction(const reactor *owner)
+{
+   for (auto frame = construction_stack; nullptr != frame; frame = frame->outer)
+   {
+      if (owner == frame->owner)
+      {
+         return frame->id;
+      }
+   }
+   return nullptr;
+}
+
+bool is_constructing(const reactor *owner)
+{
+   return nullptr != innermost_construction(owner);
+}
+
+bool is_constructing(const reactor *owner, const index &id)
+{
+   for (auto frame = construction_stack; nullptr != frame; frame = frame->outer)
+   {
+      if (owner == frame->owner && id == *frame->id)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+class construction_scope
+{
+ public:
+   construction_scope(const reactor *owner, const index &id)
+         : _frame{owner, &id, construction_stack}
+   {
+      construction_stack = &_frame;
+   }
+   ~construction_scope() { construction_stack = _frame.outer; }
+
+   construction_scope(const construction_scope &) = delete;
+   construction_scope &operator=(const construction_scope &) = delete;
+
+ private:
+   const construction_frame _frame;
+};
+
+// The reactor whose next generation the current thread is building in reset_objects_async()
+thread_local const reactor *shadow_builder_of = nullptr;
+
+// The reactor whose objects the current thread is destructing in a parallel teardown, its destructors may still
+// construct objects while the reset holds back every other thread
+thread_local const reactor *teardown_worker_of = nullptr;
+
+// Wave 0 holds the objects nothing depends on, every later wave only the dependencies of the earlier ones
+std::vector<std::vector<size_t>> teardown_waves(const std::vector<index> &ids, const dependency_graph &graph)
+{
+   flat_map<index, size_t> positions;
+   for (size_t i = 0; i < ids.size(); ++i)
+   {
+      positions.try_emplace(ids[i], i);
+   }
+
+   // Objects complete after their dependencies, so walking backwards every dependent of an object is placed already
+   std::vector<size_t> levels(ids.size(), 0);
+   std::vector<std::vector<size_t>> waves;
+   for (size_t i = ids.size(); i-- > 0;)
+   {
+      const dependency_graph::node *node = graph.find(ids[i]);
+      if (nullptr != node)
+      {
+         for (auto &dependency : node->dependencies)
+         {
+            auto it = positions.find(dependency);
+            if (it != positions.end() && it->second < i)
+            {
+               levels[it->second] = std::max(levels[it->second], levels[i] + 1);
+            }
+         }
+      }
+
+      if (waves.size() <= levels[i])
+      {
+         waves.resize(levels[i] + 1);
+      }
+      waves[levels[i]].push_back(i);
+   }
+
+   return waves;
+}
+
+// The new positions of the objects once a late dependency of dependent on id is recorded: dependent and the objects
+// depending on it are moved after id, keeping their order. Empty if nothing has to move.
+std::vector<size_t> late_dependency_order(const index &dependent, const index &id,
+      const std::vector<std::pair<index, std::chrono::nanoseconds>> &creation_order, dependency_graph &graph)
+{
+   const size_t none = creation_order.size();
+   size_t dependent_pos = none;
+   size_t id_pos = none;
+   for (size_t i = 0; i < creation_order.size(); ++i)
+   {
+      if (dependent == creation_order[i].first)
+      {
+         dependent_pos = i;
+      }
+      else if (id == creation_order[i].first)
+      {
+         id_pos = i;
+      }
+   }
+
+   if (none == dependent_pos || none == id_pos)
+   {
+      return std::vector<size_t>(); // Destructed since, or the object was got by the dependent's constructor
+   }
+
+   graph.add_dependency(dependent, id);
+   if (id_pos < dependent_pos)
+   {
+      return std::vector<size_t>();
+   }
+
+   flat_map<index, bool> moved;
+   for (auto &item : graph.collect_dependents(dependent))
+   {
+      moved.try_emplace(item, true);
+   }
+
+   std::vector<size_t> order;
+   order.reserve(creation_order.size());
+   for (size_t i = 0; i < creation_order.size(); ++i)
+   {
+      if (i < dependent_pos || moved.end() == moved.find(creation_order[i].first))
+      {
+         order.push_back(i);
+      }
+   }
+   for (size_t i = dependent_pos; i < creation_order.size(); ++i)
+   {
+      if (moved.end() != moved.find(creation_order[i].first))
+      {
+         order.push_back(i);
+      }
+   }
+   return order;
+}
+
+template<typename C>
+void reorder(C &items, const std::vector<size_t> &order)
+{
+   C result;
+   result.reserve(items.size());
+   for (auto i : order)
+   {
+      result.push_back(std::move(items[i]));
+   }
+   items.swap(result);
+}
+
+// Kept reachable until the process exits without ever running the destructors, so leak checkers see no leak either
+void abandon(std::shared_ptr<void> &&obj)
+{
+   static std::mutex *mutex = new std::mutex();
+   static std::vector<std::shared_ptr<void>> *abandoned = new std::vector<std::shared_ptr<void>>();
+
+   std::unique_lock<std::mutex> lock(*mutex);
+   abandoned->push_back(std::move(obj));
+}
+
+} // namespace
+
+class reactor::teardown_run
+{
+ public:
+   // Only the destructor of the reactor may abandon objects, a reset must not leave anything running behind
+   teardown_run(const teardown_options &options, bool may_abandon)
+         : _options(options)
+         , _start(std::chrono::steady_clock::now())
+         , _deadline(std::chrono::steady_clock::time_point::max())
+   {
+      if (may_abandon && 0 != _options.deadline.count())
+      {
+         _deadline = _start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(_options.deadline);
+      }
+   }
+
+   void destruct(const index &id, std::shared_ptr<void> &obj)
+   {
+      const auto start = std::chrono::steady_clock::now();
+      if (start > _deadline)
+      {
+         std::unique_lock<std::mutex> lock(_mutex);
+         _report.abandoned.push_back(id);
+         // Running out of time at shutdown is better than waiting for it
+         abandon(std::move(obj));
+         return;
+      }
+
+      obj.reset();
+
+      const auto elapsed =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      if (elapsed >= _options.slow_threshold)
+      {
+         std::unique_lock<std::mutex> lock(_mutex);
+         _report.slow_destructors.push_back(teardown_report::slow_destructor{id, elapsed});
+      }
+   }
+
+   teardown_report finish()
+   {
+      _report.total_time =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+      return std::move(_report);
+   }
+
+ private:
+   const teardown_options _options;
+   const std::chrono::steady_clock::time_point _start;
+   std::chrono::steady_clock::time_point _deadline;
+   std::mutex _mutex;
+   teardown_report _report;
+};
+
+reactor::reactor(bool stage_registrations)
+      : _object_snapshot(new object_snapshot())
+      , _background_idle(0)
+      , _background_stopping(false)
+      , _next_handle(0)
+      , _resets_pending(0)
+      , _static_tables(nullptr)
+      , _staged(nullptr)
+      , _staging(stage_registrations)
+      , _frozen(nullptr)
+      , _reaper_busy(false)
+      , _reaper_stopping(false)
+      , _shutting_down(false)
+      , _epoch_domain(epoch_domain::instance())
+      , _generation(next_generation())
+      , _factory_generation(next_generation())
+      , _shadow(nullptr)
 {
+   for (auto &chunk : _type_slots)
+   {
+      chunk.store(nullptr, std::memory_order_relaxed);
+   }
+   for (auto &chunk : _handle_chunks)
+   {
+      chunk.store(nullptr, std::memory_order_relaxed);
+   }
 }
 
 reactor::~reactor()
 {
+   // Prewarming and async gets may still be constructing objects, the workers run every queued task before leaving
+   std::vector<std::thread> background_threads;
+   {
+      std::unique_lock<std::mutex> background_lock(_background_mutex);
+      _background_stopping = true;
+      background_threads.swap(_background_threads);
+   }
+   _background_cv.notify_all();
+   for (auto &thread : background_threads)
+   {
+      thread.join();
+   }
+
+   // Whatever earlier resets handed to the reaper goes before the rest
+   stop_reaper();
+
    std::unique_lock<std::recursive_mutex> reset_objects_lock(_reset_objects_mutex);
    _shutting_down = true;
 
+   if (!_profile_path.empty())
+   {
+      try
+      {
+         save_profile(_profile_path);
+      }
+      catch (...)
+      {
+         // The profile is only an optimization for the next start, it can't fail the shutdown
+      }
+   }
+
    std::unique_lock<pf::might_shared_mutex> factory_write_lock(_factory_mutex);
+   _static_tables.store(nullptr, std::memory_order_relaxed);
+   for (auto staged = _staged.exchange(nullptr); nullptr != staged;)
+   {
+      std::unique_ptr<staged_registration> item(staged);
+      staged = item->next;
+   }
+   _staged_factories.clear();
    _factory_map.clear();
    factory_write_lock.unlock();
 
    reset_objects();
+
+   // No reader can be left at this point, the last (empty) snapshot can go directly
+   delete _object_snapshot.load();
+
+   for (auto &chunk : _type_slots)
+   {
+      delete[] chunk.load();
+   }
+   for (auto &chunk : _handle_chunks)
+   {
+      delete[] chunk.load();
+   }
 }
 
 void reactor::register_factory(
-      const std::string &instance, priorities priority, const std::shared_ptr<factory_base> &factory)
+      pf::string_view instance, priorities priority, const std::shared_ptr<factory_base> &factory)
 {
+   check_not_frozen();
+   if (_staging.load(std::memory_order_acquire))
+   {
+      auto staged = pf::make_unique<staged_registration>(index(factory->get_type(), instance), priority);
+      staged->factory = factory;
+
+      // Refuse the conflict here, the registrator winning at the first lookup wouldn't know it lost
+      std::unique_lock<std::mutex> staged_lock(_staged_factories_mutex);
+      if (_staging.load(std::memory_order_acquire))
+      {
+         auto &staged_priorities = _staged_factories[staged->id];
+         if (staged_priorities.end() != std::find(staged_priorities.begin(), staged_priorities.end(), priority))
+         {
+            throw type_already_registred_exception(factory->get_type(), staged->id.get_name(), priority);
+         }
+         staged_priorities.push_back(priority);
+         stage(std::move(staged));
+         return;
+      }
+   }
+
    std::unique_lock<pf::might_shared_mutex> factory_write_lock(_factory_mutex);
+   check_not_frozen();
 
    const index id(factory->get_type(), instance);
    auto it = _factory_map.find(id);
@@ -59,25 +441,41 @@ void reactor::register_factory(
    {
       // If there is no, insert the new
       prio_map.insert({priority, factory});
+      // Invalidate the misses cached in contracts
+      _factory_generation.store(next_generation(), std::memory_order_release);
    }
    else
    {
       // Otherwise raise an error
-      throw type_already_registred_exception(factory->get_type(), instance, priority);
+      throw type_already_registred_exception(factory->get_type(), id.get_name(), priority);
    }
 }
 
-void reactor::unregister_factory(const std::string &instance, priorities priority, const std::type_info &type)
+void reactor::unregister_factory(pf::string_view instance, priorities priority, const std::type_info &type)
 {
-   std::unique_lock<pf::might_shared_mutex> factory_write_lock(_factory_mutex);
+   unregister_factory(instance, priority, type, nullptr);
+}
 
-   const index id(type, instance);
+void reactor::unregister_factory(
+      pf::string_view instance, priorities priority, const std::shared_ptr<factory_base> &factory)
+{
+   unregister_factory(instance, priority, factory->get_type(), factory);
+}
 
-   auto it = _factory_map.find(id);
+void reactor::unregister_factory(pf::string_view instance, priorities priority, const std::type_info &type,
+      const std::shared_ptr<factory_base> &factory)
+{
+   merge_pending_registrations();
+
+   std::unique_lock<pf::might_shared_mutex> factory_write_lock(_factory_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
+
+   index id(type);
+   auto it = index::find(type, instance, id) ? _factory_map.find(id) : _factory_map.end();
    if (it == _factory_map.end())
    {
       // No factory found for the given parameters
-      throw factory_not_registred_exception(type, instance);
+      throw factory_not_registred_exception(type, std::string(instance.data(), instance.size()));
    }
 
    auto &prio_map = it->second;
@@ -86,7 +484,13 @@ void reactor::unregister_factory(const std::string &instance, priorities priorit
    if (it_prio == prio_map.end())
    {
       // No factory found for the given parameters
-      throw factory_not_registred_exception(type, instance);
+      throw factory_not_registred_exception(type, id.get_name());
+   }
+
+   if (nullptr != factory && it_prio->second != factory)
+   {
+      // Registered by an other registration, this one lost against it
+      return;
    }
 
    // Found the factory in prio_map, remove it!
@@ -99,9 +503,147 @@ void reactor::unregister_factory(const std::string &instance, priorities priorit
    }
 }
 
-size_t reactor::register_addon(const std::string &instance, priorities priority, std::unique_ptr<addon_base> &&addon)
+void reactor::register_static_factories(static_factory_table &table)
+{
+   check_not_frozen();
+
+   table._next = _static_tables.load(std::memory_order_relaxed);
+   while (!_static_tables.compare_exchange_weak(table._next, &table, std::memory_order_release,
+         std::memory_order_relaxed))
+   {
+   }
+
+   // Invalidate the misses cached in contracts, the next lookup merges the table
+   _factory_generation.store(next_generation(), std::memory_order_release);
+}
+
+void reactor::stage(std::unique_ptr<staged_registration> &&registration)
+{
+   staged_registration *item = registration.release();
+   item->next = _staged.load(std::memory_order_relaxed);
+   while (!_staged.compare_exchange_weak(item->next, item, std::memory_order_release, std::memory_order_relaxed))
+   {
+   }
+
+   // A merge may have drained the stage and bumped the generation before the push, the misses cached since would
+   // hide the item. The next lookup not served by a cached miss merges it.
+   _factory_generation.store(next_generation(), std::memory_order_release);
+}
+
+void reactor::merge_pending_registrations() const
+{
+   // Registrations made from now on go directly into the registries
+   if (_staging.load(std::memory_order_relaxed))
+   {
+      _staging.store(false, std::memory_order_release);
+   }
+
+   if (nullptr == _static_tables.load(std::memory_order_acquire) && nullptr == _staged.load(std::memory_order_acquire))
+   {
+      return;
+   }
+
+   // The queued registrations are already registered as far as the callers are concerned, merging them is not a change
+   reactor *self = const_cast<reactor *>(this);
+   std::unique_lock<pf::might_shared_mutex> factory_write_lock(self->_factory_mutex);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(self->_addon_mutex);
+   self->merge_pending_registrations_locked();
+}
+
+void reactor::merge_pending_registrations_locked()
+{
+   static_factory_table *pending_tables = _static_tables.exchange(nullptr, std::memory_order_acquire);
+   staged_registration *pending = nullptr;
+   {
+      // The registrations staged from now on are checked against the registry
+      std::unique_lock<std::mutex> staged_lock(_staged_factories_mutex);
+      pending = _staged.exchange(nullptr, std::memory_order_acquire);
+      _staged_factories.clear();
+   }
+   if (nullptr == pending_tables && nullptr == pending)
+   {
+      return;
+   }
+
+   // Merge in the order of registration, static tables first as they are queued in the static init phase
+   std::vector<static_factory_table *> tables;
+   for (; nullptr != pending_tables; pending_tables = pending_tables->_next)
+   {
+      tables.push_back(pending_tables);
+   }
+   std::vector<std::unique_ptr<staged_registration>> staged;
+   for (; nullptr != pending; pending = pending->next)
+   {
+      staged.emplace_back(pending);
+   }
+
+   std::unique_ptr<type_already_registred_exception> conflict;
+   auto add_factory = [this, &conflict](const index &id, priorities priority, const std::type_info &type,
+                            const std::function<std::shared_ptr<factory_base>()> &make) {
+      auto &prio_map = _factory_map[id];
+      if (0 != prio_map.count(priority))
+      {
+         // Keep merging, the other registrations are not to blame
+         if (nullptr == conflict)
+         {
+            conflict = pf::make_unique<type_already_registred_exception>(type, id.get_name(), priority);
+         }
+         return;
+      }
+
+      prio_map.insert({priority, make()});
+   };
+
+   _factory_map.reserve(_factory_map.size() + staged.size());
+   for (auto it = tables.rbegin(); it != tables.rend(); ++it)
+   {
+      for (auto &item : **it)
+      {
+         add_factory(index(*item.type, item.instance), item.priority, *item.type, item.make);
+      }
+   }
+
+   for (auto it = staged.rbegin(); it != staged.rend(); ++it)
+   {
+      auto &item = **it;
+      if (nullptr != item.factory)
+      {
+         add_factory(item.id, item.priority, item.factory->get_type(), [&item]() { return item.factory; });
+      }
+      else if (nullptr != item.addon)
+      {
+         _addon_map[item.id].emplace(item.priority, addon_holder{item.reg_id, std::move(item.addon)});
+      }
+      else
+      {
+         _addon_filter_map[item.id].emplace(item.priority, addon_filter_holder{item.reg_id, std::move(item.filter)});
+      }
+   }
+
+   // Invalidate the misses cached in contracts
+   _factory_generation.store(next_generation(), std::memory_order_release);
+
+   if (nullptr != conflict)
+   {
+      throw *conflict;
+   }
+}
+
+size_t reactor::register_addon(pf::string_view instance, priorities priority, std::unique_ptr<addon_base> &&addon)
 {
+   check_not_frozen();
+   if (_staging.load(std::memory_order_acquire))
+   {
+      auto staged = pf::make_unique<staged_registration>(index(addon->get_type(), instance), priority);
+      staged->reg_id = _addon_id++;
+      staged->addon = std::move(addon);
+      const size_t reg_id = staged->reg_id;
+      stage(std::move(staged));
+      return reg_id;
+   }
+
    std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   check_not_frozen();
 
    const index id(addon->get_type(), instance);
    const size_t reg_id = _addon_id++;
@@ -110,13 +652,15 @@ size_t reactor::register_addon(const std::string &instance, priorities priority,
    return reg_id;
 }
 
-size_t reactor::unregister_addons(const std::string &instance, const std::type_info &type)
+size_t reactor::unregister_addons(pf::string_view instance, const std::type_info &type)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_map.find(id) : _addon_map.end();
    if (it == _addon_map.end())
    {
       // No addon found for the given parameters
@@ -134,13 +678,15 @@ size_t reactor::unregister_addons(const std::string &instance, const std::type_i
    return num_erased;
 }
 
-size_t reactor::unregister_addons(const std::string &instance, priorities priority, const std::type_info &type)
+size_t reactor::unregister_addons(pf::string_view instance, priorities priority, const std::type_info &type)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_map.find(id) : _addon_map.end();
    if (it == _addon_map.end())
    {
       // No addon found for the given parameters
@@ -160,17 +706,19 @@ size_t reactor::unregister_addons(const std::string &instance, priorities priori
    return num_erased;
 }
 
-void reactor::unregister_addon(const std::string &instance, const std::type_info &type, size_t reg_id)
+void reactor::unregister_addon(pf::string_view instance, const std::type_info &type, size_t reg_id)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_map.find(id) : _addon_map.end();
    if (it == _addon_map.end())
    {
       // No addon found for the given parameters
-      throw addon_not_registred_exception(type, instance);
+      throw addon_not_registred_exception(type, std::string(instance.data(), instance.size()));
    }
 
    auto &prio_map = it->second;
@@ -180,7 +728,7 @@ void reactor::unregister_addon(const std::string &instance, const std::type_info
    if (it_prio == prio_map.end())
    {
       // No addon found for the given parameters
-      throw addon_not_registred_exception(type, instance);
+      throw addon_not_registred_exception(type, std::string(instance.data(), instance.size()));
    }
 
    prio_map.erase(it_prio);
@@ -193,9 +741,21 @@ void reactor::unregister_addon(const std::string &instance, const std::type_info
 }
 
 size_t reactor::register_addon_filter(
-      const std::string &instance, priorities priority, std::unique_ptr<addon_filter_base> &&filter)
+      pf::string_view instance, priorities priority, std::unique_ptr<addon_filter_base> &&filter)
 {
+   check_not_frozen();
+   if (_staging.load(std::memory_order_acquire))
+   {
+      auto staged = pf::make_unique<staged_registration>(index(filter->get_type(), instance), priority);
+      staged->reg_id = _addon_filter_id++;
+      staged->filter = std::move(filter);
+      const size_t reg_id = staged->reg_id;
+      stage(std::move(staged));
+      return reg_id;
+   }
+
    std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   check_not_frozen();
 
    const index id(filter->get_type(), instance);
    const size_t reg_id = _addon_filter_id++;
@@ -204,13 +764,15 @@ size_t reactor::register_addon_filter(
    return reg_id;
 }
 
-size_t reactor::unregister_addon_filters(const std::string &instance, const std::type_info &type)
+size_t reactor::unregister_addon_filters(pf::string_view instance, const std::type_info &type)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_filter_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_filter_map.find(id) : _addon_filter_map.end();
    if (it == _addon_filter_map.end())
    {
       // No addon filter found for the given parameters
@@ -228,13 +790,15 @@ size_t reactor::unregister_addon_filters(const std::string &instance, const std:
    return num_erased;
 }
 
-size_t reactor::unregister_addon_filters(const std::string &instance, priorities priority, const std::type_info &type)
+size_t reactor::unregister_addon_filters(pf::string_view instance, priorities priority, const std::type_info &type)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_filter_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_filter_map.find(id) : _addon_filter_map.end();
    if (it == _addon_filter_map.end())
    {
       // No addon_filter found for the given parameters
@@ -254,17 +818,19 @@ size_t reactor::unregister_addon_filters(const std::string &instance, priorities
    return num_erased;
 }
 
-void reactor::unregister_addon_filter(const std::string &instance, const std::type_info &type, size_t reg_id)
+void reactor::unregister_addon_filter(pf::string_view instance, const std::type_info &type, size_t reg_id)
 {
-   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   merge_pending_registrations();
 
-   const index id(type, instance);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+   _frozen.store(nullptr, std::memory_order_release); // Unregistering thaws, see freeze()
 
-   auto it = _addon_filter_map.find(id);
+   index id(type);
+   auto it = index::find(type, instance, id) ? _addon_filter_map.find(id) : _addon_filter_map.end();
    if (it == _addon_filter_map.end())
    {
       // No addon filter found for the given parameters
-      throw addon_filter_not_registred_exception(type, instance);
+      throw addon_filter_not_registred_exception(type, std::string(instance.data(), instance.size()));
    }
 
    auto &prio_map = it->second;
@@ -274,7 +840,7 @@ void reactor::unregister_addon_filter(const std::string &instance, const std::ty
    if (it_prio == prio_map.end())
    {
       // No addon filter found for the given parameters
-      throw addon_filter_not_registred_exception(type, instance);
+      throw addon_filter_not_registred_exception(type, std::string(instance.data(), instance.size()));
    }
 
    prio_map.erase(it_prio);
@@ -290,42 +856,1832 @@ void reactor::reset_objects()
 {
    std::unique_lock<std::recursive_mutex> reset_objects_lock(_reset_objects_mutex);
 
-   sig_before_reset_objects();
+   if (is_constructing(this))
+   {
+      // The objects under construction might already hold references to objects that would be destructed
+      throw std::logic_error("reset_objects() called while constructing an object");
+   }
 
-   // Do not change the locking order!
-   // get() locks the map and list in this order, so we do the same to avoid dead locks
-   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
-   std::unique_lock<pf::might_shared_mutex> object_map_write_lock(_object_map_mutex);
+   sig_before_reset_objects();
 
-   // The map holds weak copies so we can simply clear it
-   _object_map.clear();
+   // Before holding back constructions, start() may still be getting its dependencies. The objects are still
+   // reachable, so stop() can use them too
+   stop_services();
 
-   // Ensure reverse destruction order of the objects
-   while (!_object_list.empty())
    {
-      _object_list.pop_back();
+      // Hold back new constructions and wait for the running ones, so nothing is published into the old generation
+      // after it was cleared
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      ++_resets_pending;
+      _reset_thread = std::this_thread::get_id();
+      _construction_cv.wait(construction_lock, [this] { return _constructions.empty(); });
    }
 
-   object_map_write_lock.unlock();
-   object_list_lock.unlock();
+   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
 
-   if (!_shutting_down)
+   const teardown_options options = _teardown_options;
+   const bool deferred = options.deferred && !_shutting_down;
+   const bool detach = deferred || 1 != options.concurrency;
+   teardown_batch batch;
+   batch.options = options;
+   if (detach && 1 != options.concurrency)
    {
-      sig_after_reset_objects();
+      std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+      batch.graph = _dependency_graph;
    }
-}
 
-bool reactor::validate_contracts() const
-{
-   std::unique_lock<std::mutex> contract_lock(_contract_mutex);
+   bool handles_released = hide_objects();
 
-   for (auto it = _contract_list.begin(); it != _contract_list.end(); ++it)
+   teardown_run run(options, _shutting_down);
+
+   if (detach)
+   {
+      {
+         std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+         batch.objects.swap(_object_list);
+         _object_owners.clear();
+      }
+      batch.ids.reserve(_creation_order.size());
+      for (auto &item : _creation_order)
+      {
+         batch.ids.push_back(item.first);
+      }
+      _creation_order.clear();
+   }
+
+   // Nothing is published while constructions are held back, the destructors may construct objects from here on
+   object_list_lock.unlock();
+
+   if (handles_released)
+   {
+      // Wait for the readers that might have resolved a handle before the release. Not holding the object list, a
+      // reader may be waiting for it inside its read section.
+      _epoch_domain.synchronize();
+   }
+
+   if (deferred)
+   {
+      queue_teardown(std::move(batch));
+   }
+   else if (detach)
+   {
+      destruct_batch(batch, run);
+   }
+
+   // Ensure reverse destruction order of the objects, including the ones constructed by destructors
+   for (;;)
+   {
+      std::shared_ptr<void> obj;
+      index id(typeid(void));
+      bool done = false;
+      handles_released = false;
+      {
+         std::unique_lock<std::recursive_mutex> pop_lock(_object_list_mutex);
+         if (!_object_snapshot.load(std::memory_order_relaxed)->empty())
+         {
+            // A destructor constructed objects, they are destructed by this loop too
+            handles_released = hide_objects();
+         }
+
+         std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+         done = _object_list.empty();
+         if (!done)
+         {
+            obj = std::move(_object_list.back());
+            _object_list.pop_back();
+            _object_owners.erase(obj.get());
+            id = _creation_order.back().first;
+            _creation_order.pop_back();
+         }
+      }
+
+      if (handles_released)
+      {
+         _epoch_domain.synchronize();
+      }
+      if (done)
+      {
+         break;
+      }
+
+      // Destruct without holding any lock, destructors may still use the reactor
+      run.destruct(id, obj);
+   }
+
+   if (!deferred)
+   {
+      const teardown_report report = run.finish();
+      sig_teardown_report(report);
+   }
+
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      if (0 == --_resets_pending)
+      {
+         _reset_thread = std::thread::id();
+      }
+   }
+   _construction_cv.notify_all();
+
+   if (!_shutting_down)
+   {
+      sig_after_reset_objects();
+   }
+}
+
+void reactor::reset(const contract_base &contract)
+{
+   const index id = contract.get_index();
+   reset_selected("reset()", [this, &id]() {
+      std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+      return _dependency_graph.collect_dependents(id);
+   });
+}
+
+object_checkpoint reactor::checkpoint()
+{
+   object_checkpoint result;
+   result._owner = this;
+
+   std::vector<std::pair<index, std::shared_ptr<void>>> objects;
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+      objects.reserve(_object_list.size());
+      for (size_t i = 0; i < _object_list.size(); ++i)
+      {
+         objects.emplace_back(_creation_order[i].first, _object_list[i]);
+      }
+   }
+
+   // Without holding the object list, the lookup may merge pending registrations
+   result._entries.reserve(objects.size());
+   for (auto &item : objects)
+   {
+      result._entries.push_back(object_checkpoint::entry{item.first, item.second, find_factory(item.first)});
+   }
+
+   return result;
+}
+
+void reactor::restore(const object_checkpoint &cp)
+{
+   if (this != cp._owner)
+   {
+      throw std::invalid_argument("restore() got a checkpoint of an other reactor");
+   }
+
+   reset_selected("restore()", [this, &cp]() { return changed_since(cp); });
+
+   for (auto &item : cp._entries)
+   {
+      if (nullptr != find_object(item.id))
+      {
+         continue; // Kept, or built already as the dependency of an earlier one
+      }
+
+      auto factory = find_factory(item.id);
+      if (nullptr != factory)
+      {
+         create_object(factory->get_type(), item.id, factory);
+      }
+   }
+}
+
+std::vector<index> reactor::changed_since(const object_checkpoint &cp)
+{
+   flat_map<index, const object_checkpoint::entry *> recorded;
+   for (auto &item : cp._entries)
+   {
+      recorded.try_emplace(item.id, &item);
+   }
+
+   std::vector<std::pair<index, std::shared_ptr<void>>> objects;
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+      objects.reserve(_object_list.size());
+      for (size_t i = 0; i < _object_list.size(); ++i)
+      {
+         objects.emplace_back(_creation_order[i].first, _object_list[i]);
+      }
+   }
+
+   std::vector<index> changed;
+   for (auto &item : objects)
+   {
+      // An object destructed and created again since has the same index, but not the same owner
+      auto it = recorded.find(item.first);
+      if (it == recorded.end() || it->second->object.lock() != item.second ||
+            it->second->factory != find_factory(item.first))
+      {
+         changed.push_back(item.first);
+      }
+   }
+
+   std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+   return _dependency_graph.collect_dependents(changed);
+}
+
+void reactor::reset_selected(const char *caller, const std::function<std::vector<index>()> &select)
+{
+   std::unique_lock<std::recursive_mutex> reset_objects_lock(_reset_objects_mutex);
+
+   if (is_constructing(this))
+   {
+      throw std::logic_error(std::string(caller) + " called while constructing an object");
+   }
+
+   // The observers can't tell which objects go, they drop everything they cached like for reset_objects()
+   sig_before_reset_objects();
+
+   std::vector<index> ids = select();
+
+   // Like reset_objects(), before holding back constructions
+   stop_services(&ids);
+
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      ++_resets_pending;
+      _reset_thread = std::this_thread::get_id();
+      _construction_cv.wait(construction_lock, [this] { return _constructions.empty(); });
+   }
+
+   // Objects might have been constructed since the services were stopped, nothing is constructed from now on
+   ids = select();
+
+   std::vector<std::pair<index, std::shared_ptr<void>>> removed; // In order of creation
+   bool handles_released = false;
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+
+      {
+         std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+         _dependency_graph.remove(ids);
+      }
+
+      // Everything else stays visible, the readers of the old snapshot are reclaimed through the epoch domain
+      publish_objects(_object_snapshot.load(std::memory_order_relaxed)->without(ids));
+      _generation.store(next_generation(), std::memory_order_release);
+
+      flat_map<index, bool> selected;
+      for (auto &item : ids)
+      {
+         selected.try_emplace(item, true);
+      }
+
+      {
+         std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+
+         object_list objects;
+         std::vector<std::pair<index, std::chrono::nanoseconds>> creation_order;
+         objects.reserve(_object_list.size());
+         creation_order.reserve(_creation_order.size());
+         for (size_t i = 0; i < _object_list.size(); ++i)
+         {
+            if (selected.end() == selected.find(_creation_order[i].first))
+            {
+               objects.push_back(std::move(_object_list[i]));
+               creation_order.push_back(_creation_order[i]);
+               continue;
+            }
+
+            auto handle = _object_handles.find(_object_list[i].get());
+            if (handle != _object_handles.end())
+            {
+               release_handle(handle->second);
+               _object_handles.erase(handle);
+               handles_released = true;
+            }
+            removed.emplace_back(_creation_order[i].first, std::move(_object_list[i]));
+         }
+
+         // Positions changed, the reverse index has to be rebuilt
+         _object_list.swap(objects);
+         _creation_order.swap(creation_order);
+         _object_owners.clear();
+         for (size_t i = 0; i < _object_list.size(); ++i)
+         {
+            _object_owners.try_emplace(_object_list[i].get(), i);
+         }
+      }
+
+      {
+         std::unique_lock<std::mutex> services_lock(_services_mutex);
+         for (auto &item : ids)
+         {
+            _services.erase(item);
+         }
+      }
+
+   }
+
+   if (handles_released)
+   {
+      // Wait for the readers that might have resolved a handle before the release. Not holding the object list, a
+      // reader may be waiting for it inside its read section.
+      _epoch_domain.synchronize();
+   }
+
+   // Dependents first, without any lock held, destructors may still use the reactor
+   while (!removed.empty())
+   {
+      removed.pop_back();
+   }
+
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      if (0 == --_resets_pending)
+      {
+         _reset_thread = std::thread::id();
+      }
+   }
+   _construction_cv.notify_all();
+
+   sig_after_reset_objects();
+}
+
+std::shared_future<void> reactor::reset_objects_async()
+{
+   if (is_constructing(this))
+   {
+      throw std::logic_error("reset_objects_async() called while constructing an object");
+   }
+
+   auto done = std::make_shared<std::promise<void>>();
+   std::shared_future<void> result = done->get_future().share();
+   run_in_background([this, done]() {
+      try
+      {
+         swap_generation();
+         done->set_value();
+      }
+      catch (...)
+      {
+         done->set_exception(std::current_exception());
+      }
+   });
+
+   return result;
+}
+
+void reactor::swap_generation()
+{
+   std::unique_lock<std::recursive_mutex> reset_objects_lock(_reset_objects_mutex);
+
+   construction_items items;
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+      items.reserve(_creation_order.size());
+      for (auto &item : _creation_order)
+      {
+         items.emplace_back(item.first, nullptr);
+      }
+   }
+
+   merge_pending_registrations();
+   {
+      pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+      for (auto &item : items)
+      {
+         auto it = _factory_map.find(item.first);
+         if (it != _factory_map.end())
+         {
+            item.second = it->second.rbegin()->second;
+         }
+      }
+   }
+
+   // Build the next generation on this thread, get() finds only its objects here while the others see the current one
+   auto shadow = pf::make_unique<shadow_generation>();
+   _shadow.store(shadow.get(), std::memory_order_release);
+   shadow_builder_of = this;
+   try
+   {
+      for (auto &item : items)
+      {
+         // Objects without a factory by now are left out, an earlier item may have built the rest as a dependency
+         if (nullptr != item.second && nullptr == shadow->snapshot.find(item.first))
+         {
+            create_shadow_object(item.second->get_type(), item.first, item.second);
+         }
+      }
+   }
+   catch (...)
+   {
+      shadow_builder_of = nullptr;
+      _shadow.store(nullptr, std::memory_order_release);
+      while (!shadow->objects.empty())
+      {
+         shadow->objects.pop_back();
+      }
+      throw;
+   }
+   shadow_builder_of = nullptr;
+   _shadow.store(nullptr, std::memory_order_release);
+
+   {
+      // Constructions of the current generation must not be published into the next one
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      ++_resets_pending;
+      _reset_thread = std::this_thread::get_id();
+      _construction_cv.wait(construction_lock, [this] { return _constructions.empty(); });
+   }
+
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+
+      publish_objects(new object_snapshot(std::move(shadow->snapshot)));
+      // Contracts cached objects of the old generation
+      _generation.store(next_generation(), std::memory_order_release);
+
+      // Release the old handles before the owners change, they are looked up by object address
+      release_handles();
+      {
+         std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+         _object_list.swap(shadow->objects);
+         _object_owners.clear();
+         for (size_t i = 0; i < _object_list.size(); ++i)
+         {
+            _object_owners.try_emplace(_object_list[i].get(), i);
+         }
+      }
+      _creation_order.swap(shadow->creation_order);
+      {
+         std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+         std::swap(_dependency_graph, shadow->graph);
+      }
+      {
+         std::unique_lock<std::mutex> services_lock(_services_mutex);
+         std::swap(_services, shadow->services);
+      }
+   }
+
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      if (0 == --_resets_pending)
+      {
+         _reset_thread = std::thread::id();
+      }
+   }
+   _construction_cv.notify_all();
+
+   // From here on the shadow holds the old generation, get() already returns the new objects to the observers
+   sig_before_reset_objects();
+
+   // Wait for the readers that might have found an old object
+   _epoch_domain.synchronize();
+
+   for (auto item = shadow->creation_order.rbegin(); item != shadow->creation_order.rend(); ++item)
+   {
+      auto service = shadow->services.find(item->first);
+      if (service != shadow->services.end() && service->second.started)
+      {
+         try
+         {
+            service->second.obj->stop();
+         }
+         catch (...)
+         {
+            // The object is going to be destructed anyway
+         }
+      }
+   }
+
+   // Dependents first, without any lock held
+   while (!shadow->objects.empty())
+   {
+      shadow->objects.pop_back();
+   }
+
+   sig_after_reset_objects();
+}
+
+bool reactor::is_shadow_builder() const
+{
+   return this == shadow_builder_of;
+}
+
+void *reactor::find_shadow_object(const index &id) const
+{
+   return _shadow.load(std::memory_order_relaxed)->snapshot.find(id);
+}
+
+void *reactor::create_shadow_object(
+      const std::type_info &type, const index &id, const std::shared_ptr<factory_base> &selected_factory)
+{
+   if (is_constructing(this, id))
+   {
+      throw std::runtime_error("Recursive call to reactor.get() on the same object");
+   }
+
+   shadow_generation &shadow = *_shadow.load(std::memory_order_relaxed);
+
+   std::shared_ptr<void> obj;
+   lifecycle *service = nullptr;
+   const auto start = std::chrono::steady_clock::now();
+   {
+      // A single thread builds the shadow, it needs no single-flight
+      construction_scope scope(this, id);
+      factory_result result = selected_factory->produce(id.get_name());
+      obj = result.get(type);
+      service = result.get_lifecycle();
+   }
+   const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+   shadow.objects.push_back(obj);
+   shadow.creation_order.emplace_back(id, elapsed);
+   shadow.snapshot.insert(id, obj.get());
+   shadow.graph.set_construction_time(id, elapsed);
+   if (nullptr != service)
+   {
+      shadow.services.try_emplace(id, service_state{service, false});
+   }
+
+   return obj.get();
+}
+
+void reactor::destruct_batch(teardown_batch &batch, teardown_run &run)
+{
+   if (1 == batch.options.concurrency)
+   {
+      while (!batch.objects.empty())
+      {
+         run.destruct(batch.ids.back(), batch.objects.back());
+         batch.objects.pop_back();
+         batch.ids.pop_back();
+      }
+      return;
+   }
+
+   for (auto &wave : teardown_waves(batch.ids, batch.graph))
+   {
+      task_list tasks;
+      tasks.reserve(wave.size());
+      for (size_t i : wave)
+      {
+         tasks.emplace_back([this, &run, &batch, i]() {
+            teardown_worker_of = this;
+            run.destruct(batch.ids[i], batch.objects[i]);
+            teardown_worker_of = nullptr;
+         });
+      }
+      run_tasks_on_threads(std::move(tasks), batch.options.concurrency);
+   }
+   batch.objects.clear();
+}
+
+void reactor::queue_teardown(teardown_batch batch)
+{
+   std::unique_lock<std::mutex> reaper_lock(_reaper_mutex);
+   _reaper_queue.push_back(std::move(batch));
+   if (!_reaper.joinable())
+   {
+      _reaper = std::thread([this]() { reaper_loop(); });
+   }
+   _reaper_cv.notify_all();
+}
+
+void reactor::reaper_loop()
+{
+   std::unique_lock<std::mutex> reaper_lock(_reaper_mutex);
+   for (;;)
+   {
+      _reaper_cv.wait(reaper_lock, [this] { return _reaper_stopping || !_reaper_queue.empty(); });
+      if (_reaper_queue.empty())
+      {
+         return; // Stopping, and nothing left
+      }
+
+      teardown_batch batch = std::move(_reaper_queue.front());
+      _reaper_queue.pop_front();
+      _reaper_busy = true;
+      reaper_lock.unlock();
+
+      teardown_run run(batch.options, false);
+      destruct_batch(batch, run);
+      const teardown_report report = run.finish();
+      sig_teardown_report(report);
+
+      reaper_lock.lock();
+      _reaper_busy = false;
+      _reaper_cv.notify_all();
+   }
+}
+
+void reactor::drain()
+{
+   std::unique_lock<std::mutex> reaper_lock(_reaper_mutex);
+   if (std::this_thread::get_id() == _reaper.get_id())
+   {
+      throw std::logic_error("drain() called by the reaper");
+   }
+
+   _reaper_cv.wait(reaper_lock, [this] { return _reaper_queue.empty() && !_reaper_busy; });
+}
+
+void reactor::stop_reaper()
+{
+   std::thread reaper;
+   {
+      std::unique_lock<std::mutex> reaper_lock(_reaper_mutex);
+      _reaper_stopping = true;
+      reaper.swap(_reaper);
+   }
+   _reaper_cv.notify_all();
+
+   if (reaper.joinable())
+   {
+      reaper.join();
+   }
+}
+
+void reactor::set_teardown_options(const teardown_options &options)
+{
+   std::unique_lock<std::recursive_mutex> reset_objects_lock(_reset_objects_mutex);
+   _teardown_options = options;
+   if (0 == _teardown_options.concurrency)
+   {
+      _teardown_options.concurrency = std::max(1u, std::thread::hardware_concurrency());
+   }
+}
+
+void reactor::instantiate_all(const executor &exec, size_t concurrency)
+{
+   if (is_constructing(this))
+   {
+      throw std::logic_error("instantiate_all() called while constructing an object");
+   }
+
+   construct_items(planned_items(), exec, concurrency);
+}
+
+void reactor::instantiate_all(size_t concurrency)
+{
+   if (is_constructing(this))
+   {
+      throw std::logic_error("instantiate_all() called while constructing an object");
+   }
+
+   construct_items_on_threads(planned_items(), concurrency);
+}
+
+void reactor::start_services(const executor &exec, size_t concurrency)
+{
+   if (is_constructing(this))
+   {
+      throw std::logic_error("start_services() called while constructing an object");
+   }
+
+   std::unique_lock<std::mutex> service_lifecycle_lock(_service_lifecycle_mutex);
+   start_waves(make_service_waves(false), [&exec, concurrency](task_list tasks) {
+      run_tasks(std::move(tasks), exec, concurrency);
+   });
+}
+
+void reactor::start_services(size_t concurrency)
+{
+   if (is_constructing(this))
+   {
+      throw std::logic_error("start_services() called while constructing an object");
+   }
+
+   std::unique_lock<std::mutex> service_lifecycle_lock(_service_lifecycle_mutex);
+   start_waves(make_service_waves(false),
+         [concurrency](task_list tasks) { run_tasks_on_threads(std::move(tasks), concurrency); });
+}
+
+bool reactor::is_lazy(const contract_base &contract)
+{
+   auto factory = find_factory(contract.get_index());
+   return nullptr != factory && factory->is_lazy();
+}
+
+bool reactor::is_service_ready(const index &id) const
+{
+   if (nullptr == find_object(id))
+   {
+      return false;
+   }
+
+   std::unique_lock<std::mutex> services_lock(_services_mutex);
+   auto it = _services.find(id);
+   return it == _services.end() || it->second.started;
+}
+
+reactor::service_waves reactor::make_service_waves(bool started, const std::vector<index> *only) const
+{
+   flat_map<index, bool> selected;
+   if (nullptr != only)
+   {
+      for (auto &item : *only)
+      {
+         selected.try_emplace(item, true);
+      }
+   }
+
+   std::vector<std::pair<index, lifecycle *>> services;
+   {
+      std::unique_lock<std::mutex> services_lock(_services_mutex);
+      for (auto &item : _services)
+      {
+         if (item.second.started == started && (nullptr == only || selected.end() != selected.find(item.first)))
+         {
+            services.emplace_back(item.first, item.second.obj);
+         }
+      }
+   }
+
+   if (services.empty())
+   {
+      return service_waves();
+   }
+
+   // Wave of an object is one past the deepest of its dependencies, the recorded graph can't have cycles
+   const dependency_graph graph = get_dependency_graph();
+   flat_map<index, size_t> levels;
+   std::function<size_t(const index &)> level_of = [&graph, &levels, &level_of](const index &id) -> size_t {
+      auto it = levels.find(id);
+      if (it != levels.end())
+      {
+         return it->second;
+      }
+
+      size_t level = 0;
+      const dependency_graph::node *node = graph.find(id);
+      if (nullptr != node)
+      {
+         for (auto &dependency : node->dependencies)
+         {
+            level = std::max(level, level_of(dependency) + 1);
+         }
+      }
+
+      levels.try_emplace(id, level);
+      return level;
+   };
+
+   service_waves waves;
+   for (auto &service : services)
+   {
+      const size_t level = level_of(service.first);
+      if (waves.size() <= level)
+      {
+         waves.resize(level + 1);
+      }
+      waves[level].push_back(service);
+   }
+
+   // Levels skipped by objects not implementing lifecycle leave empty waves behind
+   waves.erase(std::remove_if(waves.begin(), waves.end(),
+                     [](const service_waves::value_type &wave) { return wave.empty(); }),
+         waves.end());
+
+   return waves;
+}
+
+void reactor::start_waves(service_waves waves, const std::function<void(task_list)> &run)
+{
+   for (auto &wave : waves)
+   {
+      task_list tasks;
+      tasks.reserve(wave.size());
+      for (auto &service : wave)
+      {
+         tasks.emplace_back([this, service]() {
+            service.second->start();
+
+            std::unique_lock<std::mutex> services_lock(_services_mutex);
+            auto it = _services.find(service.first);
+            if (it != _services.end())
+            {
+               it->second.started = true;
+            }
+         });
+      }
+
+      // Dependents of a failed service must not be started
+      run(std::move(tasks));
+   }
+}
+
+void reactor::stop_services(const std::vector<index> *only)
+{
+   std::unique_lock<std::mutex> service_lifecycle_lock(_service_lifecycle_mutex);
+
+   service_waves waves = make_service_waves(true, only);
+   for (auto wave = waves.rbegin(); wave != waves.rend(); ++wave)
+   {
+      task_list tasks;
+      tasks.reserve(wave->size());
+      for (auto &service : *wave)
+      {
+         tasks.emplace_back([this, service]() {
+            try
+            {
+               service.second->stop();
+            }
+            catch (...)
+            {
+               // The object is going to be destructed anyway
+            }
+
+            std::unique_lock<std::mutex> services_lock(_services_mutex);
+            auto it = _services.find(service.first);
+            if (it != _services.end())
+            {
+               it->second.started = false;
+            }
+         });
+      }
+
+      // Also runs from the destructor at shutdown, a wave of hundreds of services must not start a thread each
+      run_tasks_on_threads(std::move(tasks), 0);
+   }
+}
+
+reactor::construction_items reactor::planned_items() const
+{
+   construction_items items;
+   merge_pending_registrations();
+
+   // Start with the objects that declared no dependencies, so the workers rarely have to wait for each other
+   pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+   size_t unplanned;
+   auto levels = plan_levels(unplanned);
+   items.reserve(_factory_map.size());
+   for (auto &level : levels)
+   {
+      for (auto &id : level)
+      {
+         auto &factory = _factory_map.find(id)->second.rbegin()->second;
+         if (!factory->is_lazy())
+         {
+            items.emplace_back(id, factory);
+         }
+      }
+   }
+
+   // A cycle in the declared dependencies does not have to be real, leave the rest to the constructors
+   if (0 != unplanned)
+   {
+      for (auto &item : _factory_map)
+      {
+         auto planned = std::find_if(items.begin(), items.end(),
+               [&item](const construction_items::value_type &p) { return p.first == item.first; });
+         if (planned == items.end() && !item.second.rbegin()->second->is_lazy())
+         {
+            items.emplace_back(item.first, item.second.rbegin()->second);
+         }
+      }
+   }
+
+   return items;
+}
+
+void reactor::construct_items(construction_items items, const executor &exec, size_t concurrency)
+{
+   run_tasks(make_construction_tasks(std::move(items)), exec, concurrency);
+}
+
+void reactor::construct_items_on_threads(construction_items items, size_t concurrency)
+{
+   run_tasks_on_threads(make_construction_tasks(std::move(items)), concurrency);
+}
+
+reactor::task_list reactor::make_construction_tasks(construction_items items)
+{
+   task_list tasks;
+   tasks.reserve(items.size());
+   for (auto &item : items)
+   {
+      std::shared_ptr<factory_base> factory = std::move(item.second);
+      const index id = item.first;
+      tasks.emplace_back([this, id, factory]() {
+         if (nullptr == find_object(id))
+         {
+            create_object(factory->get_type(), id, factory);
+         }
+      });
+   }
+
+   return tasks;
+}
+
+void reactor::run_tasks(task_list tasks, const executor &exec, size_t concurrency)
+{
+   struct work
+   {
+      task_list tasks;
+      std::atomic_size_t next;
+      std::mutex mutex;
+      std::condition_variable cv;
+      size_t running;
+      std::exception_ptr error;
+   };
+
+   auto state = std::make_shared<work>();
+   state->tasks = std::move(tasks);
+   state->next = 0;
+   state->running = 0;
+
+   auto worker = [state]() {
+      for (size_t i = state->next++; i < state->tasks.size(); i = state->next++)
+      {
+         try
+         {
+            state->tasks[i]();
+         }
+         catch (...)
+         {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (!state->error)
+            {
+               state->error = std::current_exception();
+            }
+         }
+      }
+
+      {
+         std::unique_lock<std::mutex> lock(state->mutex);
+         --state->running;
+      }
+      state->cv.notify_all();
+   };
+
+   // More workers than tasks would only start idle
+   const size_t workers = std::max<size_t>(1, std::min(concurrency, state->tasks.size()));
+   state->running = workers;
+
+   for (size_t i = 1; i < workers; ++i)
+   {
+      try
+      {
+         exec(worker);
+      }
+      catch (...)
+      {
+         // The remaining workers still finish the whole list
+         std::unique_lock<std::mutex> lock(state->mutex);
+         state->running -= workers - i;
+         break;
+      }
+   }
+
+   worker();
+
+   std::unique_lock<std::mutex> lock(state->mutex);
+   state->cv.wait(lock, [&state] { return 0 == state->running; });
+
+   if (state->error)
+   {
+      std::rethrow_exception(state->error);
+   }
+}
+
+void reactor::run_tasks_on_threads(task_list tasks, size_t concurrency)
+{
+   if (0 == concurrency)
+   {
+      concurrency = std::max(1u, std::thread::hardware_concurrency());
+   }
+
+   std::vector<std::thread> threads;
+   std::exception_ptr error;
+   try
+   {
+      run_tasks(std::move(tasks),
+            [&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); }, concurrency);
+   }
+   catch (...)
+   {
+      error = std::current_exception();
+   }
+
+   // The workers are done by now, but the threads must be joined even if a task failed
+   for (auto &thread : threads)
+   {
+      thread.join();
+   }
+
+   if (error)
+   {
+      std::rethrow_exception(error);
+   }
+}
+
+void reactor::set_async_executor(const executor &exec)
+{
+   std::unique_lock<std::mutex> background_lock(_background_mutex);
+   _async_executor = exec;
+}
+
+void reactor::run_in_background(std::function<void()> task)
+{
+   std::unique_lock<std::mutex> background_lock(_background_mutex);
+   if (_async_executor)
+   {
+      executor exec = _async_executor;
+      background_lock.unlock();
+      exec(std::move(task));
+      return;
+   }
+
+   background_lock.unlock();
+   run_on_worker(std::move(task));
+}
+
+void reactor::run_on_worker(std::function<void()> task)
+{
+   std::unique_lock<std::mutex> background_lock(_background_mutex);
+   _background_tasks.push_back(std::move(task));
+
+   // Workers are kept for later tasks, so there are never more of them than tasks were running at once
+   if (_background_tasks.size() > _background_idle)
+   {
+      _background_threads.emplace_back([this]() { background_loop(); });
+   }
+   else
+   {
+      _background_cv.notify_one();
+   }
+}
+
+void reactor::background_loop()
+{
+   std::unique_lock<std::mutex> background_lock(_background_mutex);
+   for (;;)
+   {
+      ++_background_idle;
+      _background_cv.wait(background_lock, [this] { return _background_stopping || !_background_tasks.empty(); });
+      --_background_idle;
+      if (_background_tasks.empty())
+      {
+         return; // Stopping, and nothing left
+      }
+
+      std::function<void()> task = std::move(_background_tasks.front());
+      _background_tasks.pop_front();
+      background_lock.unlock();
+      task();
+      task = nullptr; // Whatever the task captured goes before the next one is waited for
+      background_lock.lock();
+   }
+}
+
+void reactor::save_profile(const std::string &path) const
+{
+   std::vector<std::pair<index, std::chrono::nanoseconds>> creation_order;
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+      creation_order = _creation_order;
+   }
+
+   std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc);
+   out << profile_header << "\n";
+   for (auto &item : creation_order)
+   {
+      out << item.second.count() << '\t';
+      write_profile_field(out, item.first.get_type().name());
+      out << '\t';
+      write_profile_field(out, item.first.get_name());
+      out << '\n';
+   }
+
+   out.flush();
+   if (!out)
+   {
+      throw std::runtime_error("Can't write profile: " + path);
+   }
+}
+
+void reactor::set_profile_path(const std::string &path)
+{
+   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+   _profile_path = path;
+}
+
+std::shared_future<void> reactor::prewarm_from(const std::string &path, size_t concurrency)
+{
+   std::promise<void> done;
+   std::shared_future<void> result(done.get_future());
+
+   std::ifstream in(path.c_str());
+   if (!in)
+   {
+      // Nothing to replay on the first start
+      done.set_value();
+      return result;
+   }
+
+   std::string line;
+   if (!std::getline(in, line) || profile_header != line)
+   {
+      throw std::runtime_error("Not a reactor profile: " + path);
+   }
+
+   // Types are known by name only through the registered factories
+   flat_map<std::string, const std::type_info *> types;
+   merge_pending_registrations();
+   {
+      pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+      for (auto &item : _factory_map)
+      {
+         const std::type_info &type = item.second.rbegin()->second->get_type();
+         types.try_emplace(type.name(), &type);
+      }
+   }
+
+   construction_items items;
+   while (std::getline(in, line))
+   {
+      std::vector<std::string> fields = read_profile_fields(line);
+      if (3 != fields.size())
+      {
+         throw std::runtime_error("Malformed reactor profile: " + path);
+      }
+
+      auto type = types.find(fields[1]);
+      if (type == types.end())
+      {
+         continue;
+      }
+
+      const index id(*type->second, fields[2]);
+      auto factory = find_factory(id);
+      if (nullptr != factory)
+      {
+         items.emplace_back(id, factory);
+      }
+   }
+
+   // std::function needs copyable captures
+   auto shared_items = std::make_shared<construction_items>(std::move(items));
+   auto shared_done = std::make_shared<std::promise<void>>(std::move(done));
+   run_on_worker([this, shared_items, concurrency, shared_done]() {
+      try
+      {
+         construct_items_on_threads(std::move(*shared_items), concurrency);
+         shared_done->set_value();
+      }
+      catch (...)
+      {
+         shared_done->set_exception(std::current_exception());
+      }
+   });
+
+   return result;
+}
+
+std::vector<std::vector<index>> reactor::build_plan() const
+{
+   merge_pending_registrations();
+
+   pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+
+   size_t unplanned;
+   auto levels = plan_levels(unplanned);
+   if (0 != unplanned)
+   {
+      throw std::runtime_error("Dependency cycle in the declared dependencies");
+   }
+
+   return levels;
+}
+
+std::vector<std::vector<index>> reactor::plan_levels(size_t &unplanned) const
+{
+   // Kahn's algorithm over the dependencies declared by the highest priority factory of each index
+   std::vector<index> ids;
+   flat_map<index, size_t> positions;
+   ids.reserve(_factory_map.size());
+   positions.reserve(_factory_map.size());
+   for (auto &item : _factory_map)
+   {
+      positions.try_emplace(item.first, ids.size());
+      ids.push_back(item.first);
+   }
+
+   std::vector<size_t> pending(ids.size(), 0);
+   std::vector<std::vector<size_t>> dependents(ids.size());
+   for (size_t i = 0; i < ids.size(); ++i)
+   {
+      for (auto &type : _factory_map.find(ids[i])->second.rbegin()->second->get_dependencies())
+      {
+         auto it = positions.find(index(type));
+         if (it != positions.end())
+         {
+            dependents[it->second].push_back(i);
+            ++pending[i];
+         }
+      }
+   }
+
+   std::vector<size_t> current;
+   for (size_t i = 0; i < ids.size(); ++i)
+   {
+      if (0 == pending[i])
+      {
+         current.push_back(i);
+      }
+   }
+
+   std::vector<std::vector<index>> levels;
+   unplanned = ids.size();
+   while (!current.empty())
+   {
+      std::vector<size_t> next;
+      levels.emplace_back();
+      for (size_t i : current)
+      {
+         levels.back().push_back(ids[i]);
+         for (size_t dependent : dependents[i])
+         {
+            if (0 == --pending[dependent])
+            {
+               next.push_back(dependent);
+            }
+         }
+      }
+
+      unplanned -= current.size();
+      current.swap(next);
+   }
+
+   // Whatever is left is part of (or depends on) a cycle
+   return levels;
+}
+
+void *reactor::create_object(
+      const std::type_info &type, const index &id, const std::shared_ptr<factory_base> &selected_factory)
+{
+   if (building_shadow())
+   {
+      return create_shadow_object(type, id, selected_factory);
+   }
+
+   if (is_constructing(this, id))
+   {
+      throw std::runtime_error("Recursive call to reactor.get() on the same object");
+   }
+
+   const std::thread::id self = std::this_thread::get_id();
+   const bool nested = is_constructing(this);
+   std::shared_ptr<construction> state;
+
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+
+      for (;;)
+      {
+         // Recheck under the lock, constructions are published before they are retired from _constructions
+         void *existing = find_object(id);
+         if (nullptr != existing)
+         {
+            return existing;
+         }
+
+         auto it = _constructions.find(id);
+         if (it != _constructions.end())
+         {
+            std::shared_ptr<construction> other = it->second;
+
+            // Waiting for a thread that is (transitively) waiting for us would never end, it is a dependency cycle
+            for (auto c = other; nullptr != c;)
+            {
+               if (self == c->owner)
+               {
+                  throw std::runtime_error("Recursive call to reactor.get() on the same object");
+               }
+               auto wi = _construction_waits.find(c->owner);
+               c = (wi == _construction_waits.end()) ? nullptr : wi->second;
+            }
+
+            _construction_waits[self] = other;
+            _construction_cv.wait(construction_lock, [&other] { return other->done; });
+            _construction_waits.erase(self);
+
+            if (other->error)
+            {
+               std::rethrow_exception(other->error);
+            }
+            return other->obj;
+         }
+
+         // Constructions already running may finish their dependencies, the resetting thread may rebuild from
+         // destructors, everything else waits for the reset to complete
+         if (0 == _resets_pending || nested || self == _reset_thread || this == teardown_worker_of)
+         {
+            break;
+         }
+         _construction_cv.wait(construction_lock);
+      }
+
+      state = std::make_shared<construction>();
+      state->owner = self;
+      state->done = false;
+      state->obj = nullptr;
+      _constructions.try_emplace(id, state);
+   }
+
+   std::shared_ptr<void> obj;
+   lifecycle *service = nullptr;
+   const auto start = std::chrono::steady_clock::now();
+   try
+   {
+      // Only this object is locked, so its constructor can get its dependencies and unrelated objects can be
+      // constructed by other threads meanwhile
+      construction_scope scope(this, id);
+      factory_result result = selected_factory->produce(id.get_name());
+      obj = result.get(type);
+      service = result.get_lifecycle();
+   }
+   catch (...)
+   {
+      finish_construction(id, *state, nullptr, std::current_exception());
+      throw;
+   }
+
+   const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+   {
+      std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+      {
+         std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+         _object_list.push_back(obj);
+         _object_owners.try_emplace(obj.get(), _object_list.size() - 1);
+      }
+      _creation_order.emplace_back(id, elapsed);
+      publish_objects(_object_snapshot.load(std::memory_order_relaxed)->with(id, obj.get()));
+   }
+
+   {
+      std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+      _dependency_graph.set_construction_time(id, elapsed);
+   }
+
+   if (nullptr != service)
+   {
+      std::unique_lock<std::mutex> services_lock(_services_mutex);
+      _services.try_emplace(id, service_state{service, false});
+   }
+
+   finish_construction(id, *state, obj.get(), nullptr);
+   return obj.get();
+}
+
+void reactor::finish_construction(const index &id, construction &state, void *obj, std::exception_ptr error)
+{
+   {
+      std::unique_lock<std::mutex> construction_lock(_construction_mutex);
+      state.obj = obj;
+      state.error = error;
+      state.done = true;
+      _constructions.erase(id);
+   }
+
+   _construction_cv.notify_all();
+}
+
+bool reactor::is_constructing_thread()
+{
+   return nullptr != construction_stack;
+}
+
+void reactor::record_dependency(const index &id)
+{
+   const index *dependent = innermost_construction(this);
+   if (nullptr == dependent)
+   {
+      return; // An other thread is constructing, this get() is not a dependency
+   }
+
+   if (building_shadow())
+   {
+      _shadow.load(std::memory_order_relaxed)->graph.add_dependency(*dependent, id);
+      return;
+   }
+
+   std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+   _dependency_graph.add_dependency(*dependent, id);
+}
+
+void reactor::record_lazy_dependency(const index &dependent, const index &id)
+{
+   if (building_shadow())
+   {
+      shadow_generation &shadow = *_shadow.load(std::memory_order_relaxed);
+      const std::vector<size_t> order = late_dependency_order(dependent, id, shadow.creation_order, shadow.graph);
+      if (!order.empty())
+      {
+         reorder(shadow.objects, order);
+         reorder(shadow.creation_order, order);
+      }
+      return;
+   }
+
+   std::unique_lock<std::recursive_mutex> object_list_lock(_object_list_mutex);
+
+   std::vector<size_t> order;
+   {
+      std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+      order = late_dependency_order(dependent, id, _creation_order, _dependency_graph);
+   }
+   if (order.empty())
+   {
+      return;
+   }
+
+   std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+   reorder(_object_list, order);
+   reorder(_creation_order, order);
+   _object_owners.clear();
+   for (size_t i = 0; i < _object_list.size(); ++i)
+   {
+      _object_owners.try_emplace(_object_list[i].get(), i);
+   }
+}
+
+bool reactor::current_construction(index &result) const
+{
+   const index *id = innermost_construction(this);
+   if (nullptr == id)
+   {
+      return false;
+   }
+
+   result = *id;
+   return true;
+}
+
+dependency_graph reactor::get_dependency_graph() const
+{
+   std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+   return _dependency_graph;
+}
+
+std::shared_ptr<void> reactor::find_owner(const void *obj) const
+{
+   if (building_shadow())
+   {
+      for (auto &item : _shadow.load(std::memory_order_relaxed)->objects)
+      {
+         if (obj == item.get())
+         {
+            return item;
+         }
+      }
+      throw std::runtime_error("Object not found");
+   }
+
+   pf::might_shared_lock<pf::might_shared_mutex> owner_read_lock(_object_owner_mutex);
+
+   auto it = _object_owners.find(obj);
+   if (it == _object_owners.end())
+   {
+      throw std::runtime_error("Object not found");
+   }
+
+   return _object_list[it->second];
+}
+
+void reactor::issue_handle(void *obj, uint32_t &slot, uint32_t &generation)
+{
+   {
+      pf::might_shared_lock<pf::might_shared_mutex> owner_read_lock(_object_owner_mutex);
+      auto it = _object_handles.find(obj);
+      if (it != _object_handles.end())
+      {
+         slot = it->second;
+         generation = _handle_chunks[slot / handle_chunk_size].load(std::memory_order_relaxed)[slot % handle_chunk_size]
+                            .generation.load(std::memory_order_relaxed);
+         return;
+      }
+   }
+
+   std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+
+   if (0 == _object_owners.count(obj))
+   {
+      throw std::runtime_error("Object not found"); // Released by a reset since it was returned by get()
+   }
+
+   // Recheck, an other thread might have issued it since we've released the read lock
+   auto it = _object_handles.find(obj);
+   if (it != _object_handles.end())
+   {
+      slot = it->second;
+   }
+   else
+   {
+      if (!_free_handles.empty())
+      {
+         slot = _free_handles.back();
+         _free_handles.pop_back();
+      }
+      else
+      {
+         if (_next_handle >= handle_chunk_size * handle_chunk_count)
+         {
+            throw std::length_error("Too many service handles");
+         }
+         slot = _next_handle++;
+
+         auto &chunk = _handle_chunks[slot / handle_chunk_size];
+         if (nullptr == chunk.load(std::memory_order_relaxed))
+         {
+            handle_entry *entries = new handle_entry[handle_chunk_size];
+            for (size_t i = 0; i < handle_chunk_size; ++i)
+            {
+               entries[i].generation.store(0, std::memory_order_relaxed);
+               entries[i].obj.store(nullptr, std::memory_order_relaxed);
+            }
+            chunk.store(entries, std::memory_order_release);
+         }
+      }
+
+      handle_entry &entry =
+            _handle_chunks[slot / handle_chunk_size].load(std::memory_order_relaxed)[slot % handle_chunk_size];
+      entry.obj.store(obj, std::memory_order_relaxed);
+      // Unique for the whole process, so a handle of an other reactor can never match
+      entry.generation.store(next_handle_generation(), std::memory_order_release);
+      _object_handles.try_emplace(obj, slot);
+   }
+
+   generation = _handle_chunks[slot / handle_chunk_size].load(std::memory_order_relaxed)[slot % handle_chunk_size]
+                      .generation.load(std::memory_order_relaxed);
+}
+
+bool reactor::hide_objects()
+{
+   // The snapshot only holds raw pointers, hide all objects from the readers before releasing them
+   publish_objects(new object_snapshot());
+   // Invalidate the objects cached in contracts. Must come after publishing the empty snapshot, so a reader seeing
+   // the new generation can only find objects created in it
+   _generation.store(next_generation(), std::memory_order_release);
+
+   {
+      std::unique_lock<std::mutex> dependency_graph_lock(_dependency_graph_mutex);
+      _dependency_graph.clear();
+   }
+   {
+      std::unique_lock<std::mutex> services_lock(_services_mutex);
+      _services.clear();
+   }
+
+   // Handles must not resolve to objects being destructed
+   return release_handles();
+}
+
+bool reactor::release_handles()
+{
+   std::unique_lock<pf::might_shared_mutex> owner_write_lock(_object_owner_mutex);
+   if (_object_handles.empty())
+   {
+      return false;
+   }
+
+   for (auto &item : _object_handles)
+   {
+      release_handle(item.second);
+   }
+   _object_handles.clear();
+
+   return true;
+}
+
+void reactor::release_handle(uint32_t slot)
+{
+   handle_entry &entry =
+         _handle_chunks[slot / handle_chunk_size].load(std::memory_order_relaxed)[slot % handle_chunk_size];
+
+   // Generation 0 is never issued, nothing resolves through a released slot until it is issued again
+   entry.generation.store(0, std::memory_order_seq_cst);
+   entry.obj.store(nullptr, std::memory_order_release);
+
+   _free_handles.push_back(slot);
+}
+
+reactor::object_snapshot *reactor::object_snapshot::with(const index &id, void *obj) const
+{
+   auto result = new object_snapshot();
+
+   const size_t base_size = (nullptr == _base) ? 0 : _base->size();
+   const size_t recent_limit = std::max<size_t>(16, static_cast<size_t>(std::sqrt(static_cast<double>(base_size))));
+   if (_recent.size() < recent_limit)
+   {
+      result->_base = _base;
+      result->_recent = _recent;
+      result->_recent.try_emplace(id, obj);
+      return result;
+   }
+
+   auto base = (nullptr == _base) ? std::make_shared<item_map>() : std::make_shared<item_map>(*_base);
+   base->reserve(base_size + _recent.size() + 1);
+   for (auto &item : _recent)
+   {
+      base->try_emplace(item.first, item.second);
+   }
+   base->try_emplace(id, obj);
+   result->_base = std::move(base);
+
+   return result;
+}
+
+reactor::object_snapshot *reactor::object_snapshot::without(const std::vector<index> &ids) const
+{
+   // Everything goes into a fresh base, resets are rare enough to pay for the full copy
+   auto base = (nullptr == _base) ? std::make_shared<item_map>() : std::make_shared<item_map>(*_base);
+   for (auto &item : _recent)
+   {
+      base->try_emplace(item.first, item.second);
+   }
+   for (auto &id : ids)
+   {
+      base->erase(id);
+   }
+
+   auto result = new object_snapshot();
+   result->_base = std::move(base);
+   return result;
+}
+
+void reactor::freeze()
+{
+   std::unique_lock<pf::might_shared_mutex> factory_write_lock(_factory_mutex);
+   std::unique_lock<pf::might_shared_mutex> addon_write_lock(_addon_mutex);
+
+   if (nullptr != _frozen.load(std::memory_order_relaxed))
+   {
+      return;
+   }
+
+   _staging.store(false, std::memory_order_release);
+   merge_pending_registrations_locked();
+
+   auto frozen = pf::make_unique<frozen_registry>();
+
+   frozen->factories.reserve(_factory_map.size());
+   for (auto &item : _factory_map)
+   {
+      frozen->factories.try_emplace(item.first, item.second.rbegin()->second);
+   }
+
+   frozen->addons.reserve(_addon_map.size());
+   for (auto &item : _addon_map)
+   {
+      auto &addons = frozen->addons[item.first];
+      for (auto &addon : item.second)
+      {
+         addons.emplace_back(addon.first, addon.second.value.get());
+      }
+   }
+
+   frozen->addon_filters.reserve(_addon_filter_map.size());
+   for (auto &item : _addon_filter_map)
+   {
+      auto &filters = frozen->addon_filters[item.first];
+      for (auto &filter : item.second)
+      {
+         filters.push_back(filter.second.value.get());
+      }
+   }
+
+   _frozen.store(frozen.get(), std::memory_order_release);
+   _frozen_registries.push_back(std::move(frozen));
+}
+
+void reactor::thaw()
+{
+   _frozen.store(nullptr, std::memory_order_release);
+}
+
+bool reactor::is_frozen() const
+{
+   return nullptr != _frozen.load(std::memory_order_acquire);
+}
+
+void reactor::check_not_frozen() const
+{
+   if (nullptr != _frozen.load(std::memory_order_relaxed))
+   {
+      throw std::logic_error("Registration is not allowed while the reactor is frozen");
+   }
+}
+
+std::shared_ptr<factory_base> reactor::find_factory(const index &id)
+{
+   const frozen_registry *frozen = _frozen.load(std::memory_order_acquire);
+   if (nullptr != frozen)
+   {
+      auto fi = frozen->factories.find(id);
+      if (fi == frozen->factories.end())
+      {
+         // Look for the default factory if there isn't a named one
+         fi = frozen->factories.find(index(id.get_type()));
+         if (fi == frozen->factories.end())
+         {
+            return nullptr;
+         }
+      }
+
+      return fi->second;
+   }
+
+   merge_pending_registrations();
+
+   pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+   auto fi = _factory_map.find(id);
+   if (fi == _factory_map.end())
+   {
+      // Look for the default factory if there isn't a named one
+      fi = _factory_map.find(index(id.get_type()));
+      if (fi == _factory_map.end())
+      {
+         return nullptr;
+      }
+   }
+
+   // Get the factory with the highest priority
+   // No validity check here, register and unregister factory should make sure that the priority map always
+   // has at least one item
+   return fi->second.rbegin()->second;
+}
+
+std::shared_ptr<factory_base> reactor::select_factory(const std::type_info &type, const index &id)
+{
+   auto factory = find_factory(id);
+   if (nullptr == factory)
+   {
+      // No factory found for the given parameters
+      throw factory_not_registred_exception(type, id.get_name());
+   }
+
+   return factory;
+}
+
+object_slot *reactor::create_type_slot_chunk(size_t chunk) const
+{
+   object_slot *slots = new object_slot[type_slot_chunk_size];
+   object_slot *expected = nullptr;
+   if (!_type_slots[chunk].compare_exchange_strong(expected, slots, std::memory_order_acq_rel))
+   {
+      // An other thread was faster, use its chunk
+      delete[] slots;
+      return expected;
+   }
+
+   return slots;
+}
+
+uint64_t reactor::next_generation()
+{
+   static std::atomic<uint64_t> generation_source(1);
+   return generation_source.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t reactor::next_handle_generation()
+{
+   static std::atomic<uint32_t> generation_source(1);
+   uint32_t generation;
+   do
+   {
+      generation = generation_source.fetch_add(1, std::memory_order_relaxed);
+   } while (0 == generation); // Reserved for empty handles, skipped on wrap around
+
+   return generation;
+}
+
+void reactor::publish_objects(const object_snapshot *snapshot)
+{
+   auto old = _object_snapshot.exchange(snapshot, std::memory_order_acq_rel);
+
+   // Readers might still look into the old snapshot, it is deleted once they've all left
+   _epoch_domain.retire(const_cast<object_snapshot *>(old),
+         [](void *ptr) { delete static_cast<object_snapshot *>(ptr); });
+}
+
+bool reactor::validate_contracts() const
+{
+   merge_pending_registrations();
+
+   {
+      pf::might_shared_lock<pf::might_shared_mutex> factory_read_lock(_factory_mutex);
+      size_t unplanned;
+      plan_levels(unplanned);
+      if (0 != unplanned)
+      {
+         return false;
+      }
+   }
+
+   std::unique_lock<std::mutex> contract_lock(_contract_mutex);
+
+   for (auto it = _contract_list.begin(); it != _contract_list.end(); ++it)
    {
       auto id = (*it)->get_index();
       auto fit = _factory_map.find(id);
       if (fit == _factory_map.end())
       {
-         fit = _factory_map.find(index(id.first, std::string()));
+         fit = _factory_map.find(index(id.get_type()));
          if (fit == _factory_map.end())
          {
             return false;
@@ -338,6 +2694,8 @@ bool reactor::validate_contracts() const
 
 reactor::contract_list reactor::unsatisfied_contracts() const
 {
+   merge_pending_registrations();
+
    std::unique_lock<std::mutex> contract_lock(_contract_mutex);
 
    contract_list list;
@@ -348,7 +2706,7 @@ reactor::contract_list reactor::unsatisfied_contracts() const
       auto fit = _factory_map.find(id);
       if (fit == _factory_map.end())
       {
-         fit = _factory_map.find(index(id.first, std::string()));
+         fit = _factory_map.find(index(id.get_type()));
       }
 
       if (fit == _factory_map.end())
@@ -0,0 +1,83 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <reactor/shared_library.hpp>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace iws {
+namespace reactor {
+
+namespace {
+
+std::string last_error()
+{
+#ifdef _WIN32
+   return "error " + std::to_string(GetLastError());
+#else
+   const char *error = dlerror();
+   return nullptr != error ? error : "unknown error";
+#endif
+}
+
+} // namespace
+
+shared_library::shared_library(const std::string &path)
+      : _path(path)
+#ifdef _WIN32
+      , _handle(LoadLibraryA(path.c_str()))
+#else
+      , _handle(dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL))
+#endif
+{
+   if (nullptr == _handle)
+   {
+      throw std::runtime_error("Failed to open shared library " + path + ": " + last_error());
+   }
+}
+
+shared_library::~shared_library()
+{
+#ifdef _WIN32
+   FreeLibrary(static_cast<HMODULE>(_handle));
+#else
+   dlclose(_handle);
+#endif
+}
+
+void *shared_library::symbol(const std::string &name) const
+{
+#ifdef _WIN32
+   void *result = reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(_handle), name.c_str()));
+#else
+   dlerror(); // A null symbol is not an error in itself, clear the previous one
+   void *result = dlsym(_handle, name.c_str());
+#endif
+   if (nullptr == result)
+   {
+      throw std::runtime_error("Symbol " + name + " not found in " + _path + ": " + last_error());
+   }
+
+   return result;
+}
+
+} // namespace reactor
+} // namespace iws
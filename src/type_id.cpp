@@ -0,0 +1,30 @@
+// Copyright 2022 Tamas Eisenberger <e.tamas@iwstudio.hu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <reactor/type_id.hpp>
+
+#include <atomic>
+
+namespace iws {
+namespace reactor {
+
+type_id::value_type type_id::next()
+{
+   // Constant initialized, so ids can be taken from the static init phase too
+   static std::atomic<value_type> source(0);
+   return source.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace reactor
+} // namespace iws
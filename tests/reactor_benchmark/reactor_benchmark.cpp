@@ -1,6 +1,11 @@
 #include <benchmark/benchmark.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include <reactor/client.hpp>
+#include <reactor/flat_map.hpp>
 #include <reactor/provider.hpp>
 
 using namespace iws::reactor;
@@ -60,4 +65,145 @@ static void BM_Reactor_CreateAndAccessHolder(benchmark::State &state)
 }
 BENCHMARK(BM_Reactor_CreateAndAccessHolder);
 
+static void BM_Reactor_AccessShared(benchmark::State &state)
+{
+   factory_registrator<i_empty, empty, false, true> registrator(prio_normal);
+   contract<i_empty> contract;
+   r.reset_objects();
+
+   for (auto _ : state)
+   {
+      std::shared_ptr<i_empty> obj = r.get_shared(contract);
+      benchmark::DoNotOptimize(obj);
+   }
+}
+BENCHMARK(BM_Reactor_AccessShared);
+
+static void BM_Reactor_Access(benchmark::State &state)
+{
+   factory_registrator<i_empty, empty, false, true> registrator(prio_normal);
+   contract<i_empty> contract;
+   r.reset_objects();
+
+   for (auto _ : state)
+   {
+      i_empty &obj = r.get(contract);
+      benchmark::DoNotOptimize(obj);
+   }
+}
+BENCHMARK(BM_Reactor_Access);
+
+static void BM_Reactor_AccessWithoutContract(benchmark::State &state)
+{
+   factory_registrator<i_empty, empty, false, true> registrator(prio_normal);
+   r.reset_objects();
+
+   for (auto _ : state)
+   {
+      i_empty &obj = r.get<i_empty>();
+      benchmark::DoNotOptimize(obj);
+   }
+}
+BENCHMARK(BM_Reactor_AccessWithoutContract);
+
+class i_missing
+{
+};
+
+static void BM_Reactor_ProbeMissingThrow(benchmark::State &state)
+{
+   contract<i_missing> contract;
+
+   for (auto _ : state)
+   {
+      try
+      {
+         benchmark::DoNotOptimize(r.get(contract));
+      }
+      catch (const factory_not_registred_exception &)
+      {
+      }
+   }
+}
+BENCHMARK(BM_Reactor_ProbeMissingThrow);
+
+static void BM_Reactor_ProbeMissingTryGet(benchmark::State &state)
+{
+   contract<i_missing> contract;
+
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(r.try_get(contract));
+   }
+}
+BENCHMARK(BM_Reactor_ProbeMissingTryGet);
+
+// Registry lookups at 10, 1k and 100k entries, the keys are shaped like the ones of the reactor registries
+
+static std::vector<iws::reactor::index> make_registry_keys(size_t count)
+{
+   std::vector<iws::reactor::index> keys;
+   keys.reserve(count);
+   for (size_t i = 0; i < count; ++i)
+   {
+      keys.emplace_back(typeid(i_empty), "instance_" + std::to_string(i));
+   }
+   return keys;
+}
+
+template<typename Map>
+static void registry_find(benchmark::State &state)
+{
+   const auto keys = make_registry_keys(static_cast<size_t>(state.range(0)));
+   Map map;
+   for (const auto &key : keys)
+   {
+      map.insert({key, nullptr});
+   }
+
+   size_t i = 0;
+   for (auto _ : state)
+   {
+      // Stride through the keys so consecutive lookups don't hit the same cache lines
+      auto it = map.find(keys[i]);
+      benchmark::DoNotOptimize(it);
+      i = (i + 7919) % keys.size();
+   }
+}
+
+static void BM_Registry_StdMapFind(benchmark::State &state)
+{
+   registry_find<std::map<iws::reactor::index, void *>>(state);
+}
+BENCHMARK(BM_Registry_StdMapFind)->Arg(10)->Arg(1000)->Arg(100000);
+
+static void BM_Registry_FlatMapFind(benchmark::State &state)
+{
+   registry_find<flat_map<iws::reactor::index, void *>>(state);
+}
+BENCHMARK(BM_Registry_FlatMapFind)->Arg(10)->Arg(1000)->Arg(100000);
+
+static void BM_Reactor_CreateObjAmongFactories(benchmark::State &state)
+{
+   const auto keys = make_registry_keys(static_cast<size_t>(state.range(0)));
+   for (const auto &key : keys)
+   {
+      r.register_factory(key.get_name(), prio_normal, std::make_shared<factory<i_empty, empty, false>>());
+   }
+   contract<i_empty> contract(keys[keys.size() / 2].get_name());
+
+   for (auto _ : state)
+   {
+      r.reset_objects();
+      i_empty &obj = r.get(contract);
+      benchmark::DoNotOptimize(obj);
+   }
+
+   for (const auto &key : keys)
+   {
+      r.unregister_factory(key.get_name(), prio_normal, typeid(i_empty));
+   }
+}
+BENCHMARK(BM_Reactor_CreateObjAmongFactories)->Arg(10)->Arg(1000)->Arg(100000);
+
 BENCHMARK_MAIN();
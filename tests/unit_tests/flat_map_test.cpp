@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <reactor/flat_map.hpp>
+
+namespace re = iws::reactor;
+
+namespace {
+
+// Sends every key into the same group so probing has to continue past full groups
+struct colliding_hash
+{
+   size_t operator()(int) const { return 42; }
+};
+
+} // namespace
+
+TEST(flat_map, empty)
+{
+   re::flat_map<int, int> map;
+
+   EXPECT_TRUE(map.empty());
+   EXPECT_EQ(0u, map.size());
+   EXPECT_TRUE(map.begin() == map.end());
+   EXPECT_TRUE(map.find(1) == map.end());
+   EXPECT_EQ(0u, map.erase(1));
+}
+
+TEST(flat_map, insert_find_erase)
+{
+   re::flat_map<std::string, int> map;
+
+   EXPECT_TRUE(map.insert({"one", 1}).second);
+   EXPECT_FALSE(map.insert({"one", 2}).second);
+   map["two"] = 2;
+   EXPECT_EQ(2u, map.size());
+
+   auto it = map.find("one");
+   ASSERT_TRUE(it != map.end());
+   EXPECT_EQ(1, it->second);
+
+   map.erase(it);
+   EXPECT_TRUE(map.find("one") == map.end());
+   EXPECT_EQ(1u, map.erase("two"));
+   EXPECT_TRUE(map.empty());
+}
+
+TEST(flat_map, matches_std_map)
+{
+   re::flat_map<int, int> map;
+   std::map<int, int> reference;
+   std::mt19937 rng(4242);
+
+   for (int i = 0; i < 20000; ++i)
+   {
+      const int key = static_cast<int>(rng() % 1000);
+      if (rng() % 3 == 0)
+      {
+         EXPECT_EQ(reference.erase(key), map.erase(key));
+      }
+      else
+      {
+         map[key] = i;
+         reference[key] = i;
+      }
+   }
+
+   ASSERT_EQ(reference.size(), map.size());
+   size_t visited = 0;
+   for (const auto &item : map)
+   {
+      EXPECT_EQ(reference.at(item.first), item.second);
+      ++visited;
+   }
+   EXPECT_EQ(reference.size(), visited);
+}
+
+TEST(flat_map, colliding_hashes)
+{
+   re::flat_map<int, int, colliding_hash> map;
+
+   for (int i = 0; i < 100; ++i)
+   {
+      map[i] = i;
+   }
+   for (int i = 0; i < 100; i += 2)
+   {
+      map.erase(i);
+   }
+
+   EXPECT_EQ(50u, map.size());
+   for (int i = 0; i < 100; ++i)
+   {
+      EXPECT_EQ(i % 2 != 0, map.find(i) != map.end());
+   }
+
+   // Tombstones must not make reinserted keys unreachable or duplicated
+   for (int i = 0; i < 100; ++i)
+   {
+      map[i] = -i;
+   }
+   EXPECT_EQ(100u, map.size());
+   EXPECT_EQ(-99, map.find(99)->second);
+}
+
+TEST(flat_map, copy_and_move)
+{
+   re::flat_map<int, std::unique_ptr<int>> source;
+   for (int i = 0; i < 100; ++i)
+   {
+      source.try_emplace(i, new int(i));
+   }
+
+   re::flat_map<int, std::unique_ptr<int>> moved(std::move(source));
+   EXPECT_TRUE(source.empty());
+   EXPECT_EQ(100u, moved.size());
+   EXPECT_EQ(50, *moved.find(50)->second);
+
+   re::flat_map<int, std::string> strings;
+   strings[1] = "one";
+   re::flat_map<int, std::string> copy(strings);
+   copy[1] = "uno";
+   EXPECT_EQ("one", strings[1]);
+   EXPECT_EQ("uno", copy[1]);
+}
@@ -1,24 +1,34 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <future>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include <reactor/contract.hpp>
+#include <reactor/depends_on.hpp>
 #include <reactor/factory.hpp>
 #include <reactor/factory_registrator.hpp>
 #include <reactor/factory_wrapper.hpp>
 #include <reactor/factory_wrapper_registrator.hpp>
+#include <reactor/lazy_proxy.hpp>
 #include <reactor/make_unique_polyfil.hpp>
+#include <reactor/plugin_factory.hpp>
 #include <reactor/pulley.hpp>
 #include <reactor/r.hpp>
 #include <reactor/reactor.hpp>
+#include <reactor/service_handle.hpp>
+#include <reactor/static_factory.hpp>
 
 #include "i_test.hpp"
 #include "test_contract.hpp"
 #include "test_lib/i_ext_test.hpp"
+#include "test_plugin/i_plugin_test.hpp"
 
 namespace sph = std::placeholders;
 
@@ -856,6 +866,1623 @@ TEST_F(reactor, instance_exists)
    EXPECT_TRUE(inst->instance_exists(ctr31));
 }
 
+TEST_F(reactor, index_interning)
+{
+   const re::index first(typeid(i_test), "interned_first");
+   const re::index first_again(typeid(i_test), std::string("interned_first"));
+   const re::index second(typeid(i_test), "interned_second");
+   const re::index other_type(typeid(test<0>), "interned_first");
+
+   EXPECT_EQ(first, first_again);
+   EXPECT_EQ(first.get_name_id(), first_again.get_name_id());
+   EXPECT_EQ(first.get_hash(), first_again.get_hash());
+   EXPECT_EQ(&first.get_name(), &first_again.get_name());
+   EXPECT_EQ("interned_first", first.get_name());
+
+   EXPECT_NE(first, second);
+   EXPECT_NE(first.get_name_id(), second.get_name_id());
+   EXPECT_NE(first, other_type);
+   EXPECT_EQ(first.get_name_id(), other_type.get_name_id());
+
+   const re::index def(typeid(i_test));
+   EXPECT_EQ(0u, def.get_name_id());
+   EXPECT_EQ(def, re::index(typeid(i_test), ""));
+   EXPECT_EQ(std::string(), def.get_name());
+}
+
+TEST_F(reactor, index_find_does_not_intern)
+{
+   re::index id(typeid(i_test));
+
+   EXPECT_FALSE(re::index::find(typeid(i_test), "never_interned_name", id));
+   EXPECT_EQ(0ul, inst->get_addons<i_test::test_addon>("never_interned_name").size());
+   EXPECT_FALSE(re::index::find(typeid(i_test), "never_interned_name", id));
+
+   const re::index interned(typeid(i_test), "now_interned_name");
+   EXPECT_TRUE(re::index::find(typeid(i_test), "now_interned_name", id));
+   EXPECT_EQ(interned, id);
+}
+
+TEST_F(reactor, epoch_retire_waits_for_readers)
+{
+   static std::atomic<int> deleted;
+   deleted = 0;
+   auto &domain = re::epoch_domain::instance();
+
+   {
+      re::epoch_guard guard;
+      std::thread([&domain]() { domain.retire(nullptr, [](void *) { ++deleted; }); }).join();
+      EXPECT_EQ(0, deleted);
+   }
+
+   // The next retirement also collects the ones not seen by any reader anymore
+   domain.retire(nullptr, [](void *) { ++deleted; });
+   EXPECT_EQ(2, deleted);
+}
+
+TEST_F(reactor, snapshot_readers_during_reset)
+{
+   constexpr int rounds = 200;
+   constexpr int threads = 4;
+
+   test_contract<test<32>> ct;
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<32>, test<32>, false>>());
+
+   std::atomic<bool> stop(false);
+   std::vector<std::thread> readers;
+   for (int i = 0; i < threads; ++i)
+   {
+      readers.emplace_back([&]() {
+         while (!stop)
+         {
+            EXPECT_NE(nullptr, &inst->get(ct));
+            inst->instance_exists(ct);
+         }
+      });
+   }
+
+   for (int i = 0; i < rounds; ++i)
+   {
+      inst->reset_objects();
+   }
+
+   stop = true;
+   for (auto &reader : readers)
+   {
+      reader.join();
+   }
+
+   EXPECT_EQ(32, inst->get(ct).get_id());
+}
+
+TEST_F(reactor, contract_slot)
+{
+   int produced = 0;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<33>>>([&produced](const std::string &) {
+            ++produced;
+            return std::make_shared<test<33>>();
+         }));
+
+   test_contract<test<33>> ct;
+   auto *first = &inst->get(ct);
+   EXPECT_EQ(first, &inst->get(ct));
+   EXPECT_EQ(first, &inst->get(test_contract<test<33>>()));
+   EXPECT_EQ(1, produced);
+
+   // The slot must not survive a reset
+   inst->reset_objects();
+   EXPECT_EQ(33, inst->get(ct).get_id());
+   EXPECT_EQ(2, produced);
+
+   // Nor be shared between reactors
+   re::reactor other;
+   other.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<33>, test<33>, false>>());
+   EXPECT_NE(&inst->get(ct), &other.get(ct));
+   EXPECT_EQ(&other.get(ct), &other.get(ct));
+   EXPECT_EQ(2, produced);
+}
+
+TEST_F(reactor, get_without_contract)
+{
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<i_test, test<34>, false>>());
+   inst->register_factory(std::string(), re::prio_override, std::make_shared<re::factory<i_test, test<35>, false>>());
+   inst->register_factory("named", re::prio_test, std::make_shared<re::factory<i_test, test<36>, false>>());
+
+   EXPECT_FALSE(inst->instance_exists<i_test>());
+
+   // Same priority rules as the default instance of a contract, named factories are not considered
+   EXPECT_EQ(35, inst->get<i_test>().get_id());
+   EXPECT_TRUE(inst->instance_exists<i_test>());
+   EXPECT_EQ(&inst->get<i_test>(), &inst->get(test_contract<i_test>()));
+
+   inst->reset_objects();
+   EXPECT_FALSE(inst->instance_exists<i_test>());
+
+   inst->unregister_factory(std::string(), re::prio_override, typeid(i_test));
+   EXPECT_EQ(34, inst->get<i_test>().get_id());
+
+   inst->unregister_factory(std::string(), re::prio_normal, typeid(i_test));
+   inst->reset_objects();
+   EXPECT_THROW(inst->get<i_test>(), re::factory_not_registred_exception);
+}
+
+TEST_F(reactor, freeze)
+{
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<i_test, test<37>, false>>());
+   inst->register_factory(std::string(), re::prio_override, std::make_shared<re::factory<i_test, test<38>, false>>());
+   inst->register_addon(std::string(), re::prio_normal,
+         pf::make_unique<re::addon<i_test::test_addon>>([](std::string) {}));
+
+   inst->freeze();
+   EXPECT_TRUE(inst->is_frozen());
+
+   EXPECT_THROW(inst->register_factory(
+                      "other", re::prio_normal, std::make_shared<re::factory<i_test, test<39>, false>>()),
+         std::logic_error);
+   EXPECT_THROW(inst->register_addon(std::string(), re::prio_normal,
+                      pf::make_unique<re::addon<i_test::test_addon>>([](std::string) {})),
+         std::logic_error);
+
+   // Lookups are served from the frozen copy with the same priorities
+   EXPECT_EQ(38, inst->get(test_contract<i_test>("named")).get_id());
+   EXPECT_EQ(1ul, inst->get_addons<i_test::test_addon>().size());
+   EXPECT_TRUE(inst->get_addons<i_test::test_addon>("named").empty());
+
+   inst->thaw();
+   EXPECT_FALSE(inst->is_frozen());
+   inst->register_factory("other", re::prio_normal, std::make_shared<re::factory<i_test, test<39>, false>>());
+   EXPECT_EQ(39, inst->get(test_contract<i_test>("other")).get_id());
+
+   // Unregistering must keep working from destructors, so it thaws instead of throwing
+   inst->freeze();
+   inst->unregister_factory("other", re::prio_normal, typeid(i_test));
+   EXPECT_FALSE(inst->is_frozen());
+}
+
+TEST_F(reactor, unrelated_objects_construct_in_parallel)
+{
+   // Each constructor waits for the other one to start, which only works if they are not serialized
+   std::promise<void> first_started;
+   std::promise<void> second_started;
+   std::shared_future<void> first_future(first_started.get_future());
+   std::shared_future<void> second_future(second_started.get_future());
+
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<40>>>([&](const std::string &) {
+            first_started.set_value();
+            EXPECT_EQ(std::future_status::ready, second_future.wait_for(std::chrono::seconds(5)));
+            return std::make_shared<test<40>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<41>>>([&](const std::string &) {
+            second_started.set_value();
+            EXPECT_EQ(std::future_status::ready, first_future.wait_for(std::chrono::seconds(5)));
+            return std::make_shared<test<41>>();
+         }));
+
+   std::thread other([this]() { EXPECT_EQ(41, inst->get(test_contract<test<41>>()).get_id()); });
+   EXPECT_EQ(40, inst->get(test_contract<test<40>>()).get_id());
+   other.join();
+}
+
+TEST_F(reactor, single_flight_construction)
+{
+   std::atomic<int> produced(0);
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<42>>>([&produced](const std::string &) {
+            ++produced;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return std::make_shared<test<42>>();
+         }));
+
+   std::vector<std::future<test<42> *>> results;
+   for (int i = 0; i < 4; ++i)
+   {
+      results.push_back(std::async(std::launch::async, [this]() { return &inst->get(test_contract<test<42>>()); }));
+   }
+
+   test<42> *first = results.front().get();
+   for (size_t i = 1; i < results.size(); ++i)
+   {
+      EXPECT_EQ(first, results[i].get());
+   }
+   EXPECT_EQ(1, produced);
+}
+
+TEST_F(reactor, cross_thread_dependency_cycle)
+{
+   std::promise<void> first_started;
+   std::promise<void> second_started;
+   std::shared_future<void> first_future(first_started.get_future());
+   std::shared_future<void> second_future(second_started.get_future());
+
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<43>>>([&](const std::string &) {
+            first_started.set_value();
+            second_future.wait();
+            inst->get(test_contract<test<44>>());
+            return std::make_shared<test<43>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<44>>>([&](const std::string &) {
+            second_started.set_value();
+            inst->get(test_contract<test<43>>());
+            return std::make_shared<test<44>>();
+         }));
+
+   // Whichever thread closes the cycle fails, and the failure propagates to the other one
+   std::thread other([&]() {
+      first_future.wait();
+      EXPECT_THROW(inst->get(test_contract<test<44>>()), std::runtime_error);
+   });
+   EXPECT_THROW(inst->get(test_contract<test<43>>()), std::runtime_error);
+   other.join();
+}
+
+TEST_F(reactor, reset_while_constructing)
+{
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<45>>>([this](const std::string &) {
+            inst->reset_objects();
+            return std::make_shared<test<45>>();
+         }));
+
+   EXPECT_THROW(inst->get(test_contract<test<45>>()), std::logic_error);
+}
+
+TEST_F(reactor, construct_while_destructing)
+{
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<107>, test<107>, false>>());
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<108>>>([r_inst](const std::string &) {
+            return std::shared_ptr<test<108>>(new test<108>(), [r_inst](test<108> *obj) {
+               r_inst->get(test_contract<test<107>>());
+               delete obj;
+            });
+         }));
+
+   test_contract<test<107>> ct;
+   inst->get(test_contract<test<108>>());
+   inst->reset_objects();
+
+   // The object constructed by the destructor was destructed by the same reset, it must not be found anymore
+   EXPECT_EQ(nullptr, inst->get_if_exists(ct));
+   EXPECT_FALSE(inst->instance_exists(ct));
+   EXPECT_EQ(107, inst->get(ct).get_id());
+}
+
+TEST_F(reactor, try_get)
+{
+   test_contract<test<46>> ct;
+
+   EXPECT_EQ(nullptr, inst->try_get(ct));
+   EXPECT_EQ(nullptr, inst->try_get(ct)); // Served from the miss cached in the contract
+   EXPECT_EQ(nullptr, inst->get_if_exists(ct));
+
+   // Registering a factory invalidates the cached miss
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<46>, test<46>, false>>());
+   EXPECT_EQ(nullptr, inst->get_if_exists(ct));
+
+   test<46> *obj = inst->try_get(ct);
+   ASSERT_NE(nullptr, obj);
+   EXPECT_EQ(46, obj->get_id());
+   EXPECT_EQ(obj, &inst->get(ct));
+   EXPECT_EQ(obj, inst->get_if_exists(ct));
+
+   // Named contracts fall back to the default factory, just like get()
+   EXPECT_EQ(46, inst->try_get(test_contract<test<46>>("named"))->get_id());
+}
+
+TEST_F(reactor, get_shared)
+{
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<47>, test<47>, false>>());
+   test_contract<test<47>> ct;
+
+   std::shared_ptr<test<47>> shared = inst->get_shared(ct);
+   ASSERT_NE(nullptr, shared);
+   EXPECT_EQ(&inst->get(ct), shared.get());
+   EXPECT_EQ(shared, inst->get_ptr(*shared));
+
+   // The reactor gives up ownership on reset
+   inst->reset_objects();
+   EXPECT_EQ(1, shared.use_count());
+   EXPECT_THROW(inst->get_ptr(*shared), std::runtime_error);
+   EXPECT_NE(shared, inst->get_shared(ct));
+}
+
+TEST_F(reactor, service_handle)
+{
+   static_assert(std::is_trivially_copyable<re::service_handle<test<48>>>::value, "handles must be plain values");
+   static_assert(8 == sizeof(re::service_handle<test<48>>), "handles must stay 8 bytes");
+
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<48>, test<48>, false>>());
+   test_contract<test<48>> ct;
+
+   re::service_handle<test<48>> empty;
+   EXPECT_FALSE(empty);
+   EXPECT_EQ(nullptr, inst->resolve(empty));
+
+   re::service_handle<test<48>> handle = inst->get_handle(ct);
+   ASSERT_TRUE(handle);
+   EXPECT_EQ(&inst->get(ct), inst->resolve(handle));
+   EXPECT_EQ(handle, inst->get_handle(ct));
+
+   // Released handles never resolve again, not even when the slot is reused
+   inst->reset_objects();
+   EXPECT_EQ(nullptr, inst->resolve(handle));
+
+   re::service_handle<test<48>> renewed = inst->get_handle(ct);
+   EXPECT_NE(handle, renewed);
+   EXPECT_EQ(nullptr, inst->resolve(handle));
+   EXPECT_EQ(&inst->get(ct), inst->resolve(renewed));
+}
+
+TEST_F(reactor, service_handle_global)
+{
+   re::r.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<49>, test<49>, false>>());
+   test_contract<test<49>> ct;
+
+   re::service_handle<test<49>> handle = re::r.get_handle(ct);
+   EXPECT_EQ(49, handle->get_id());
+   EXPECT_EQ(&re::r.get(ct), handle.get());
+
+   // Slots of other reactors start from the same index, their handles must not resolve in the global one
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<49>, test<49>, false>>());
+   re::service_handle<test<49>> foreign = inst->get_handle(ct);
+   EXPECT_EQ(nullptr, foreign.get());
+   EXPECT_EQ(&inst->get(ct), inst->resolve(foreign));
+   EXPECT_EQ(nullptr, inst->resolve(handle));
+
+   re::r.reset_objects();
+   EXPECT_EQ(nullptr, handle.get());
+
+   re::r.unregister_factory(std::string(), re::prio_normal, typeid(test<49>));
+}
+
+TEST_F(reactor, instantiate_all)
+{
+   std::mutex order_mutex;
+   std::vector<int> order;
+   auto record = [&order_mutex, &order](int id) {
+      std::unique_lock<std::mutex> lock(order_mutex);
+      order.push_back(id);
+   };
+
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<50>>>([&](const std::string &) {
+            inst->get(test_contract<test<51>>());
+            record(50);
+            return std::make_shared<test<50>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<51>>>([&](const std::string &) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            record(51);
+            return std::make_shared<test<51>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<52>>>([&](const std::string &) {
+            record(52);
+            return std::make_shared<test<52>>();
+         }));
+
+   inst->instantiate_all(4);
+
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<50>>()));
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<51>>()));
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<52>>()));
+   ASSERT_EQ(3u, order.size());
+   EXPECT_LT(std::find(order.begin(), order.end(), 51), std::find(order.begin(), order.end(), 50));
+
+   // Already created objects are skipped, the executor gets the workers beyond the calling thread
+   size_t submitted = 0;
+   inst->instantiate_all(
+         [&submitted](std::function<void()> task) {
+            ++submitted;
+            task();
+         },
+         2);
+   EXPECT_EQ(1u, submitted);
+   EXPECT_EQ(3u, order.size());
+}
+
+TEST_F(reactor, instantiate_all_error)
+{
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<53>>>(
+               [](const std::string &) -> std::shared_ptr<test<53>> { throw std::runtime_error("failed"); }));
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<54>, test<54>, false>>());
+
+   EXPECT_THROW(inst->instantiate_all(2), std::runtime_error);
+   EXPECT_FALSE(inst->instance_exists(test_contract<test<53>>()));
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<54>>()));
+}
+
+TEST_F(reactor, dependency_graph)
+{
+   test_contract<test<55>> ct_55;
+   test_contract<test<56>> ct_56;
+   test_contract<test<57>> ct_57;
+
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<55>>>([&](const std::string &) {
+            inst->get(ct_56);
+            inst->get(ct_57);
+            return std::make_shared<test<55>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<56>>>([&](const std::string &) {
+            inst->get(ct_57);
+            return std::make_shared<test<56>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<57>, test<57>, false>>());
+
+   // Cached in the contract already, the constructors must still be seen getting it
+   inst->get(ct_57);
+   inst->get(ct_55);
+
+   const re::dependency_graph graph = inst->get_dependency_graph();
+   ASSERT_EQ(3u, graph.nodes().size());
+
+   const re::dependency_graph::node *node_55 = graph.find(ct_55.get_index());
+   const re::dependency_graph::node *node_56 = graph.find(ct_56.get_index());
+   const re::dependency_graph::node *node_57 = graph.find(ct_57.get_index());
+   ASSERT_NE(nullptr, node_55);
+   ASSERT_NE(nullptr, node_56);
+   ASSERT_NE(nullptr, node_57);
+   EXPECT_EQ((std::vector<iws::reactor::index>{ct_56.get_index(), ct_57.get_index()}), node_55->dependencies);
+   EXPECT_EQ(std::vector<iws::reactor::index>{ct_57.get_index()}, node_56->dependencies);
+   EXPECT_TRUE(node_57->dependencies.empty());
+   EXPECT_GE(node_55->construction_time, node_56->construction_time);
+
+   const std::string dot = graph.to_dot();
+   EXPECT_EQ(0u, dot.find("digraph reactor {"));
+   EXPECT_EQ(3, std::count(dot.begin(), dot.end(), '>'));
+
+   const std::string json = graph.to_json();
+   EXPECT_EQ(0u, json.find("{\"nodes\":["));
+   EXPECT_NE(std::string::npos, json.find("\"dependencies\":[1,0]"));
+
+   inst->reset_objects();
+   EXPECT_TRUE(inst->get_dependency_graph().empty());
+}
+
+TEST_F(reactor, dependency_graph_dependents)
+{
+   // A chain of diamonds, every node is reachable from the first one on many paths
+   std::vector<re::index> ids;
+   for (int i = 0; i < 64; ++i)
+   {
+      ids.emplace_back(typeid(test<0>), std::to_string(i));
+   }
+   re::dependency_graph graph;
+   for (size_t i = 0; i + 2 < ids.size(); i += 2)
+   {
+      graph.add_dependency(ids[i + 1], ids[i]);
+      graph.add_dependency(ids[i + 2], ids[i]);
+      graph.add_dependency(ids[i + 2], ids[i + 1]);
+   }
+
+   EXPECT_EQ(ids.size() - 1, graph.collect_dependents(ids[0]).size());
+   EXPECT_EQ(2u, graph.collect_dependents(ids[61]).size());
+   std::vector<re::index> dependents = graph.collect_dependents(ids[60]);
+   std::sort(dependents.begin(), dependents.end());
+   std::vector<re::index> expected{ids[60], ids[61], ids[62]};
+   std::sort(expected.begin(), expected.end());
+   EXPECT_EQ(expected, dependents);
+
+   // Shared dependents of several starting points are listed once
+   EXPECT_EQ(4u, graph.collect_dependents(std::vector<re::index>{ids[59], ids[60], ids[59]}).size());
+
+   // Removing a node drops the reverse edges through it
+   graph.remove(std::vector<re::index>{ids[2]});
+   EXPECT_EQ(nullptr, graph.find(ids[2]));
+   EXPECT_EQ(2u, graph.collect_dependents(ids[0]).size());
+   EXPECT_EQ(ids.size() - 4, graph.collect_dependents(ids[3]).size());
+}
+
+namespace {
+
+struct declaring_test : public ::reactor::test<60>
+{
+   typedef re::depends_on<::reactor::test<61>, ::reactor::test<62>> dependencies;
+};
+
+} // namespace
+
+TEST_F(reactor, declared_dependencies)
+{
+   auto declaring = std::make_shared<re::factory<test<60>, declaring_test, false>>();
+   EXPECT_EQ((re::factory_base::dependency_list{typeid(test<61>), typeid(test<62>)}), declaring->get_dependencies());
+
+   auto plain = std::make_shared<re::factory<test<61>, test<61>, false>>();
+   EXPECT_TRUE(plain->get_dependencies().empty());
+   plain->set_dependencies(re::depends_on<test<62>>::types());
+
+   inst->register_factory(std::string(), re::prio_normal, declaring);
+   inst->register_factory(std::string(), re::prio_normal, plain);
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<62>, test<62>, false>>());
+
+   auto plan = inst->build_plan();
+   ASSERT_EQ(3u, plan.size());
+   EXPECT_EQ(std::vector<iws::reactor::index>{iws::reactor::index(typeid(test<62>))}, plan[0]);
+   EXPECT_EQ(std::vector<iws::reactor::index>{iws::reactor::index(typeid(test<61>))}, plan[1]);
+   EXPECT_EQ(std::vector<iws::reactor::index>{iws::reactor::index(typeid(test<60>))}, plan[2]);
+   EXPECT_TRUE(inst->validate_contracts());
+   EXPECT_EQ(0u, inst->get_dependency_graph().nodes().size());
+
+   // Close the cycle, nothing is constructed to find it
+   auto cyclic = std::make_shared<re::factory<test<62>, test<62>, false>>();
+   cyclic->set_dependencies(re::depends_on<test<60>>::types());
+   inst->register_factory(std::string(), re::prio_override, cyclic);
+
+   EXPECT_THROW(inst->build_plan(), std::runtime_error);
+   EXPECT_FALSE(inst->validate_contracts());
+   EXPECT_FALSE(inst->instance_exists(test_contract<test<62>>()));
+
+   // Only declared, the constructors don't really depend on each other
+   inst->instantiate_all(2);
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<60>>()));
+   EXPECT_TRUE(inst->instance_exists(test_contract<test<62>>()));
+}
+
+TEST_F(reactor, declared_dependencies_registrator)
+{
+   {
+      const re::factory_registrator<test<63>, test<63>, false, true> registrator(
+            re::depends_on<test<64>>(), re::prio_normal);
+      const re::factory_wrapper_registrator<test<64>, true> wrapper_registrator(
+            re::depends_on<>(), "named", re::prio_normal, [](const std::string &) {
+               return std::make_shared<test<64>>();
+            });
+
+      auto plan = re::r.build_plan();
+      const iws::reactor::index test_63(typeid(test<63>));
+      const iws::reactor::index test_64(typeid(test<64>), "named");
+
+      // Named instances are not default instances, so test<63> does not wait for this one
+      for (auto &level : plan)
+      {
+         if (level.end() != std::find(level.begin(), level.end(), test_63))
+         {
+            EXPECT_EQ(&level, &plan.front());
+         }
+      }
+      EXPECT_TRUE(std::any_of(plan.begin(), plan.end(), [&test_64](const std::vector<iws::reactor::index> &level) {
+         return level.end() != std::find(level.begin(), level.end(), test_64);
+      }));
+   }
+}
+
+TEST_F(reactor, prewarm_from_profile)
+{
+   const std::string path = ::testing::TempDir() + "reactor_prewarm_profile";
+
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<65>, test<65>, false>>());
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<66>, test<66>, false>>());
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<67>, test<67>, false>>());
+   inst->get(test_contract<test<66>>("with\ttab"));
+   inst->get(test_contract<test<67>>());
+   inst->get(test_contract<test<65>>());
+   inst->save_profile(path);
+
+   // test<67> is gone by the next start
+   re::reactor next;
+   next.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<65>, test<65>, false>>());
+   next.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<66>, test<66>, false>>());
+
+   next.prewarm_from(path, 2).get();
+   EXPECT_TRUE(next.instance_exists(mock_contract<test<65>>(&next)));
+   EXPECT_TRUE(next.instance_exists(mock_contract<test<66>>(&next, "with\ttab")));
+   EXPECT_FALSE(next.instance_exists(mock_contract<test<66>>(&next)));
+
+   // The first start has nothing to replay
+   std::remove(path.c_str());
+   re::reactor first;
+   EXPECT_NO_THROW(first.prewarm_from(path).get());
+}
+
+TEST_F(reactor, static_factory_table)
+{
+   static constexpr re::static_factory factories[] = {
+         re::static_factory_of<test<68>, test<68>>(re::prio_normal),
+         re::static_factory_of<i_test, test<69>>(re::prio_normal, "named"),
+   };
+   re::static_factory_table registration(factories, *inst);
+
+   EXPECT_EQ(68, inst->get(mock_contract<test<68>>(inst)).get_id());
+   EXPECT_EQ(69, inst->get(mock_contract<i_test>(inst, "named")).get_id());
+
+   // Overrides work like with dynamic registration
+   inst->register_factory("named", re::prio_override, std::make_shared<re::factory<i_test, test<70>, false>>());
+   inst->reset_objects();
+   EXPECT_EQ(70, inst->get(mock_contract<i_test>(inst, "named")).get_id());
+}
+
+TEST_F(reactor, static_factory_table_conflict)
+{
+   static constexpr re::static_factory factories[] = {
+         re::static_factory_of<test<71>, test<71>>(re::prio_normal),
+   };
+   static constexpr re::static_factory conflicting[] = {
+         re::static_factory_of<test<71>, test<71>>(re::prio_normal),
+         re::static_factory_of<test<72>, test<72>>(re::prio_normal),
+   };
+   re::static_factory_table registration(factories, *inst);
+   re::static_factory_table conflicting_registration(conflicting, *inst);
+
+   // Thrown by whatever consumes the tables first, the rest of them is still registered
+   EXPECT_THROW(inst->build_plan(), re::type_already_registred_exception);
+   EXPECT_EQ(71, inst->get(mock_contract<test<71>>(inst)).get_id());
+   EXPECT_EQ(72, inst->get(mock_contract<test<72>>(inst)).get_id());
+}
+
+TEST_F(reactor, static_factory_table_try_get)
+{
+   static constexpr re::static_factory factories[] = {
+         re::static_factory_of<test<109>, test<109>>(re::prio_normal),
+   };
+   mock_contract<test<109>> ct(inst);
+
+   // The miss cached before the table was queued must not hide it
+   EXPECT_EQ(nullptr, inst->try_get(ct));
+   re::static_factory_table registration(factories, *inst);
+   test<109> *obj = inst->try_get(ct);
+   ASSERT_NE(nullptr, obj);
+   EXPECT_EQ(109, obj->get_id());
+}
+
+TEST_F(reactor, static_factory_table_frozen)
+{
+   static constexpr re::static_factory factories[] = {
+         re::static_factory_of<test<110>, test<110>>(re::prio_normal),
+   };
+   mock_contract<test<110>> ct(inst);
+
+   inst->freeze();
+   EXPECT_THROW(re::static_factory_table registration(factories, *inst), std::logic_error);
+   EXPECT_EQ(nullptr, inst->try_get(ct));
+
+   inst->thaw();
+   re::static_factory_table registration(factories, *inst);
+   EXPECT_EQ(110, inst->try_get(ct)->get_id());
+}
+
+TEST_F(reactor, staged_registration)
+{
+   re::reactor staged(true);
+
+   staged.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<i_test, test<73>, false>>());
+   staged.register_factory(std::string(), re::prio_override, std::make_shared<re::factory<i_test, test<74>, false>>());
+   staged.register_factory("named", re::prio_normal, std::make_shared<re::factory<i_test, test<75>, false>>());
+   // Conflicts between staged registrations are refused right away
+   EXPECT_THROW(staged.register_factory(
+                      "named", re::prio_normal, std::make_shared<re::factory<i_test, test<76>, false>>()),
+         re::type_already_registred_exception);
+   const size_t reg_id = staged.register_addon(
+         std::string(), re::prio_normal, pf::make_unique<re::addon<i_test::test_addon>>([](std::string) {}));
+
+   // The first one registered is kept, everything else was merged
+   EXPECT_EQ(74, staged.get(mock_contract<i_test>(&staged)).get_id());
+   EXPECT_EQ(75, staged.get(mock_contract<i_test>(&staged, "named")).get_id());
+   EXPECT_EQ(1u, staged.get_addons<i_test::test_addon>().size());
+   EXPECT_NO_THROW(staged.unregister_addon(std::string(), typeid(i_test::test_addon), reg_id));
+
+   // After the first lookup registration works like before
+   EXPECT_THROW(staged.register_factory(
+                      "named", re::prio_normal, std::make_shared<re::factory<i_test, test<76>, false>>()),
+         re::type_already_registred_exception);
+}
+
+TEST_F(reactor, staged_unregistration)
+{
+   re::reactor staged(true);
+
+   staged.register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<77>, test<77>, false>>());
+   staged.unregister_factory(std::string(), re::prio_normal, typeid(test<77>));
+
+   EXPECT_EQ(nullptr, staged.try_get(mock_contract<test<77>>(&staged)));
+}
+
+TEST_F(reactor, unregister_own_factory)
+{
+   re::reactor staged(true);
+
+   auto winner = std::make_shared<re::factory<test<117>, test<117>, false>>();
+   auto loser = std::make_shared<re::factory<test<117>, test<117>, false>>();
+   staged.register_factory(std::string(), re::prio_normal, winner);
+   EXPECT_THROW(staged.register_factory(std::string(), re::prio_normal, loser), re::type_already_registred_exception);
+
+   // The registration which lost doesn't unregister the winner
+   staged.unregister_factory(std::string(), re::prio_normal, loser);
+   EXPECT_NE(nullptr, staged.try_get(mock_contract<test<117>>(&staged)));
+
+   staged.unregister_factory(std::string(), re::prio_normal, winner);
+   staged.reset_objects();
+   EXPECT_EQ(nullptr, staged.try_get(mock_contract<test<117>>(&staged)));
+}
+
+TEST_F(reactor, staged_registration_concurrent_try_get)
+{
+   const size_t writer_count = 2;
+   std::vector<std::unique_ptr<test_contract<test<113>>>> contracts;
+   for (size_t i = 0; i < writer_count; ++i)
+   {
+      contracts.emplace_back(new test_contract<test<113>>(std::to_string(i)));
+   }
+
+   for (int round = 0; round < 2000; ++round)
+   {
+      re::reactor staged(true);
+      std::atomic<bool> go(false);
+      std::atomic<size_t> registered(0);
+
+      // The first lookup ends the staging while the registrations are still coming in, a registration staged after
+      // the merge must still be found
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < writer_count; ++i)
+      {
+         threads.emplace_back([&, i]() {
+            while (!go)
+            {
+            }
+            staged.register_factory(
+                  std::to_string(i), re::prio_normal, std::make_shared<re::factory<test<113>, test<113>, false>>());
+            ++registered;
+         });
+      }
+      threads.emplace_back([&]() {
+         while (!go)
+         {
+         }
+         while (registered < writer_count)
+         {
+            for (auto &ct : contracts)
+            {
+               staged.try_get(*ct);
+            }
+         }
+      });
+
+      go = true;
+      for (auto &thread : threads)
+      {
+         thread.join();
+      }
+
+      for (auto &ct : contracts)
+      {
+         ASSERT_NE(nullptr, staged.try_get(*ct)) << "round " << round << ", " << ct->get_index().get_name();
+      }
+   }
+}
+
+TEST_F(reactor, get_async)
+{
+   std::atomic<int> produced(0);
+   std::promise<void> release;
+   std::shared_future<void> released(release.get_future());
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<78>>>([&](const std::string &) {
+            ++produced;
+            released.wait();
+            return std::make_shared<test<78>>();
+         }));
+   test_contract<test<78>> ct;
+
+   re::async_result<test<78>> result = inst->get_async(ct);
+   std::future<test<78> *> sync = std::async(std::launch::async, [&]() { return &inst->get(ct); });
+   EXPECT_FALSE(result.is_ready());
+
+   release.set_value();
+   EXPECT_EQ(78, result.get().get_id());
+   EXPECT_EQ(&result.get(), sync.get());
+   EXPECT_EQ(1, produced);
+
+   // Existing objects don't need the executor
+   EXPECT_TRUE(inst->get_async(ct).is_ready());
+}
+
+TEST_F(reactor, get_async_executor)
+{
+   std::vector<std::function<void()>> tasks;
+   inst->set_async_executor([&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); });
+
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<79>, test<79>, false>>());
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<80>>>(
+               [](const std::string &) -> std::shared_ptr<test<80>> { throw std::runtime_error("failed"); }));
+
+   auto result = inst->get_async(test_contract<test<79>>());
+   auto failing = inst->get_async(test_contract<test<80>>());
+   ASSERT_EQ(2u, tasks.size());
+   EXPECT_FALSE(result.is_ready());
+
+   for (auto &task : tasks)
+   {
+      task();
+   }
+   EXPECT_EQ(79, result.get().get_id());
+   EXPECT_THROW(failing.get(), std::runtime_error);
+}
+
+namespace {
+
+struct lifecycle_log
+{
+   std::mutex mutex;
+   std::vector<std::string> events;
+
+   void add(const std::string &event)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      events.push_back(event);
+   }
+};
+
+template<int id>
+class lifecycle_test : public ::reactor::test<id>, public re::lifecycle
+{
+ public:
+   lifecycle_test(lifecycle_log &log, bool fail = false)
+         : _log(log)
+         , _fail(fail)
+   {
+   }
+
+   virtual void start() override
+   {
+      if (_fail)
+      {
+         throw std::runtime_error("start failed");
+      }
+      _log.add("start " + std::to_string(id));
+   }
+   virtual void stop() override { _log.add("stop " + std::to_string(id)); }
+
+ private:
+   lifecycle_log &_log;
+   bool _fail;
+};
+
+} // namespace
+
+TEST_F(reactor, start_services)
+{
+   lifecycle_log log;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<82>>>(
+               [&log](const std::string &) { return std::make_shared<lifecycle_test<82>>(log); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<83>>>([&log, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<82>>(r_inst));
+            return std::make_shared<lifecycle_test<83>>(log);
+         }));
+   // Not a service, but its dependents still have to wait for the services it depends on
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<84>>>([r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<83>>(r_inst));
+            return std::make_shared<test<84>>();
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<85>>>([&log, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<84>>(r_inst));
+            return std::make_shared<lifecycle_test<85>>(log);
+         }));
+
+   EXPECT_FALSE(inst->is_ready(mock_contract<test<85>>(inst)));
+   inst->get(mock_contract<test<85>>(inst));
+   EXPECT_FALSE(inst->is_ready(mock_contract<test<85>>(inst)));
+   EXPECT_TRUE(inst->is_ready(mock_contract<test<84>>(inst)));
+   EXPECT_TRUE(log.events.empty());
+
+   inst->start_services(4);
+   EXPECT_TRUE(inst->is_ready(mock_contract<test<82>>(inst)));
+   EXPECT_TRUE(inst->is_ready(mock_contract<test<85>>(inst)));
+   EXPECT_EQ((std::vector<std::string>{"start 82", "start 83", "start 85"}), log.events);
+
+   // Already started services are left alone
+   inst->start_services(4);
+   EXPECT_EQ(3u, log.events.size());
+
+   inst->reset_objects();
+   EXPECT_FALSE(inst->is_ready(mock_contract<test<82>>(inst)));
+   EXPECT_EQ((std::vector<std::string>{"start 82", "start 83", "start 85", "stop 85", "stop 83", "stop 82"}),
+         log.events);
+}
+
+namespace {
+
+class thread_recording_service : public ::reactor::test<115>, public re::lifecycle
+{
+ public:
+   thread_recording_service(std::vector<std::thread::id> &threads, std::mutex &mutex)
+         : _threads(threads)
+         , _mutex(mutex)
+   {
+   }
+
+   virtual void start() override {}
+   virtual void stop() override
+   {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (std::find(_threads.begin(), _threads.end(), std::this_thread::get_id()) == _threads.end())
+      {
+         _threads.push_back(std::this_thread::get_id());
+      }
+   }
+
+ private:
+   std::vector<std::thread::id> &_threads;
+   std::mutex &_mutex;
+};
+
+} // namespace
+
+TEST_F(reactor, stop_services_threads)
+{
+   std::vector<std::thread::id> threads;
+   std::mutex mutex;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<115>>>([&threads, &mutex](const std::string &) {
+            return std::make_shared<thread_recording_service>(threads, mutex);
+         }));
+
+   const size_t count = 4 * std::max(1u, std::thread::hardware_concurrency()) + 16;
+   for (size_t i = 0; i < count; ++i)
+   {
+      inst->get(mock_contract<test<115>>(inst, std::to_string(i)));
+   }
+   inst->start_services();
+
+   // One wave of independent services, stopped by a bounded number of threads
+   inst->reset_objects();
+   EXPECT_FALSE(threads.empty());
+   EXPECT_LE(threads.size(), static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())));
+}
+
+TEST_F(reactor, start_services_error)
+{
+   lifecycle_log log;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<86>>>(
+               [&log](const std::string &) { return std::make_shared<lifecycle_test<86>>(log, true); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<87>>>([&log, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<86>>(r_inst));
+            return std::make_shared<lifecycle_test<87>>(log);
+         }));
+   inst->get(mock_contract<test<87>>(inst));
+
+   // The dependent of the failed service is not started, nothing is stopped that didn't start
+   EXPECT_THROW(inst->start_services(), std::runtime_error);
+   EXPECT_FALSE(inst->is_ready(mock_contract<test<86>>(inst)));
+   EXPECT_FALSE(inst->is_ready(mock_contract<test<87>>(inst)));
+   inst->reset_objects();
+   EXPECT_TRUE(log.events.empty());
+}
+
+TEST_F(reactor, plugin_factory)
+{
+   using iws::reactor_test::i_plugin_test;
+
+   auto plugin = std::make_shared<re::plugin_factory>(typeid(i_plugin_test), REACTOR_TEST_PLUGIN, "make_plugin_test");
+   inst->register_factory(std::string(), re::prio_normal, plugin);
+   EXPECT_FALSE(plugin->is_loaded());
+
+   EXPECT_TRUE(inst->get(mock_contract<i_plugin_test>(inst)).are_you_plugin());
+   EXPECT_TRUE(plugin->is_loaded());
+
+   // The objects were holding the library
+   inst->reset_objects();
+   EXPECT_FALSE(plugin->is_loaded());
+   EXPECT_TRUE(inst->get(mock_contract<i_plugin_test>(inst)).are_you_plugin());
+}
+
+TEST_F(reactor, plugin_factory_missing)
+{
+   using iws::reactor_test::i_plugin_test;
+
+   // Never opened unless resolved
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::plugin_factory>(typeid(i_plugin_test), "no_such_plugin", "make_plugin_test"));
+   inst->register_factory("bad_symbol", re::prio_normal,
+         std::make_shared<re::plugin_factory>(typeid(i_plugin_test), REACTOR_TEST_PLUGIN, "no_such_symbol"));
+
+   EXPECT_THROW(inst->get(mock_contract<i_plugin_test>(inst)), std::runtime_error);
+   EXPECT_THROW(inst->get(mock_contract<i_plugin_test>(inst, "bad_symbol")), std::runtime_error);
+}
+
+TEST_F(reactor, get_lazy)
+{
+   std::atomic<int> produced(0);
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<88>>>([&produced](const std::string &) {
+            ++produced;
+            return std::make_shared<test<88>>();
+         }));
+   mock_contract<test<88>> ct(inst);
+
+   re::lazy_proxy<test<88>> proxy = inst->get_lazy(ct);
+   EXPECT_FALSE(proxy.is_resolved());
+   EXPECT_FALSE(inst->instance_exists(ct));
+   EXPECT_EQ(0, produced);
+
+   std::vector<std::future<test<88> *>> users;
+   for (int i = 0; i < 4; ++i)
+   {
+      users.push_back(std::async(std::launch::async, [&proxy]() { return proxy.get(); }));
+   }
+   for (auto &user : users)
+   {
+      EXPECT_EQ(&inst->get(ct), user.get());
+   }
+   EXPECT_EQ(1, produced);
+   EXPECT_EQ(88, proxy->get_id());
+
+   // Copies keep the resolved object
+   re::lazy_proxy<test<88>> copy(proxy);
+   EXPECT_TRUE(copy.is_resolved());
+   EXPECT_EQ(&*proxy, &*copy);
+}
+
+namespace {
+
+struct lazy_declaring_test : public ::reactor::test<111>
+{
+   static const bool construct_lazily = true;
+};
+
+} // namespace
+
+TEST_F(reactor, lazy_factory)
+{
+   re::factory_registrator<test<111>, lazy_declaring_test, false, true> reg(re::prio_normal);
+   test_contract<test<111>> ct;
+   EXPECT_TRUE(re::r.is_lazy(ct));
+   EXPECT_FALSE(re::r.is_lazy(test_contract<test<112>>()));
+
+   // The pulley resolves on its first access only
+   re::pulley<test<111>> p;
+   EXPECT_FALSE(re::r.instance_exists(ct));
+   EXPECT_EQ(111, p->get_id());
+   EXPECT_TRUE(re::r.instance_exists(ct));
+   EXPECT_EQ(&re::r.get(ct), p.get());
+
+   // instantiate_all() leaves it out, get() still constructs it
+   auto factory = std::make_shared<re::factory<test<112>, test<112>, false>>();
+   factory->set_lazy(true);
+   inst->register_factory(std::string(), re::prio_normal, factory);
+   inst->instantiate_all(1);
+   EXPECT_FALSE(inst->instance_exists(test_contract<test<112>>()));
+   EXPECT_EQ(112, inst->get(test_contract<test<112>>()).get_id());
+}
+
+namespace {
+
+std::atomic<int> lazy_dependencies_alive(0);
+
+struct lazy_dependency : public ::reactor::test<111>
+{
+   static const bool construct_lazily = true;
+
+   lazy_dependency() { ++lazy_dependencies_alive; }
+   ~lazy_dependency() { --lazy_dependencies_alive; }
+};
+
+struct lazy_dependency_user : public ::reactor::test<114>
+{
+   ~lazy_dependency_user()
+   {
+      // The dependency resolved after this object was constructed must still be there
+      EXPECT_EQ(1, lazy_dependencies_alive.load());
+      EXPECT_EQ(111, used->get_id());
+   }
+
+   re::pulley<test<111>> used;
+};
+
+} // namespace
+
+TEST_F(reactor, lazy_pulley_dependency)
+{
+   re::factory_registrator<test<111>, lazy_dependency, false, true> lazy_reg(re::prio_normal);
+   re::factory_registrator<test<114>, lazy_dependency_user, false, true> user_reg(re::prio_normal);
+   test_contract<test<111>> lazy_ct;
+   test_contract<test<114>> user_ct;
+
+   auto &user = static_cast<lazy_dependency_user &>(re::r.get(user_ct));
+   EXPECT_FALSE(re::r.instance_exists(lazy_ct));
+
+   // Copies keep the pulley unresolved, then share the object
+   re::pulley<test<111>> copy(user.used);
+   EXPECT_EQ(111, user.used->get_id());
+   EXPECT_EQ(user.used.get(), copy.get());
+
+   // The first use recorded the dependency, reset() takes the user along
+   auto dependents = re::r.get_dependency_graph().collect_dependents(lazy_ct.get_index());
+   EXPECT_EQ(2u, dependents.size());
+   re::r.reset(lazy_ct);
+   EXPECT_FALSE(re::r.instance_exists(user_ct));
+   EXPECT_EQ(0, lazy_dependencies_alive.load());
+
+   // reset_objects() destructs the user first as well
+   static_cast<lazy_dependency_user &>(re::r.get(user_ct)).used.get();
+   re::r.reset_objects();
+   EXPECT_EQ(0, lazy_dependencies_alive.load());
+}
+
+namespace {
+
+struct teardown_probe
+{
+   std::atomic<int> dependents_destructing;
+   std::atomic<bool> overlapped;
+   std::atomic<bool> dependency_last;
+   std::chrono::milliseconds sleep;
+
+   teardown_probe()
+         : dependents_destructing(0)
+         , overlapped(true)
+         , dependency_last(false)
+         , sleep(0)
+   {
+   }
+};
+
+// Dependents wait for each other, so they only finish if they are destructed concurrently
+template<int id>
+class teardown_dependent : public ::reactor::test<id>
+{
+ public:
+   explicit teardown_dependent(teardown_probe &probe)
+         : _probe(probe)
+   {
+   }
+   ~teardown_dependent()
+   {
+      ++_probe.dependents_destructing;
+      const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (2 > _probe.dependents_destructing && std::chrono::steady_clock::now() < until)
+      {
+         std::this_thread::yield();
+      }
+      _probe.overlapped = _probe.overlapped && 2 <= _probe.dependents_destructing;
+   }
+
+ private:
+   teardown_probe &_probe;
+};
+
+template<int id>
+class teardown_dependency : public ::reactor::test<id>
+{
+ public:
+   explicit teardown_dependency(teardown_probe &probe)
+         : _probe(probe)
+   {
+   }
+   ~teardown_dependency()
+   {
+      _probe.dependency_last = 2 == _probe.dependents_destructing;
+      std::this_thread::sleep_for(_probe.sleep);
+   }
+
+ private:
+   teardown_probe &_probe;
+};
+
+} // namespace
+
+TEST_F(reactor, parallel_teardown)
+{
+   teardown_probe probe;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<89>>>(
+               [&probe](const std::string &) { return std::make_shared<teardown_dependency<89>>(probe); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<90>>>([&probe, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<89>>(r_inst));
+            return std::make_shared<teardown_dependent<90>>(probe);
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<91>>>([&probe, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<89>>(r_inst));
+            return std::make_shared<teardown_dependent<91>>(probe);
+         }));
+   inst->get(mock_contract<test<90>>(inst));
+   inst->get(mock_contract<test<91>>(inst));
+
+   re::teardown_options options;
+   options.concurrency = 2;
+   inst->set_teardown_options(options);
+   std::vector<re::teardown_report> reports;
+   const size_t connection = inst->sig_teardown_report.connect(
+         [&reports](const re::teardown_report &report) { reports.push_back(report); });
+
+   inst->reset_objects();
+   EXPECT_TRUE(probe.overlapped);
+   EXPECT_TRUE(probe.dependency_last);
+   EXPECT_FALSE(inst->instance_exists(mock_contract<test<89>>(inst)));
+   inst->sig_teardown_report.disconnect(connection);
+   ASSERT_EQ(1u, reports.size());
+   EXPECT_TRUE(reports[0].abandoned.empty());
+}
+
+TEST_F(reactor, teardown_deadline)
+{
+   teardown_probe probe;
+   probe.sleep = std::chrono::milliseconds(50);
+   re::teardown_options options;
+   options.deadline = std::chrono::milliseconds(10);
+   options.slow_threshold = std::chrono::milliseconds(20);
+   std::vector<re::teardown_report> reports;
+
+   auto populate = [&probe](re::reactor &owner) {
+      owner.register_factory(std::string(), re::prio_normal,
+            std::make_shared<re::factory_wrapper<test<92>>>(
+                  [](const std::string &) { return std::make_shared<test<92>>(); }));
+      owner.register_factory(std::string(), re::prio_normal,
+            std::make_shared<re::factory_wrapper<test<93>>>(
+                  [&probe](const std::string &) { return std::make_shared<teardown_dependency<93>>(probe); }));
+      owner.get(mock_contract<test<92>>(&owner));
+      owner.get(mock_contract<test<93>>(&owner));
+   };
+
+   // A reset destructs everything, however late it gets
+   populate(*inst);
+   inst->set_teardown_options(options);
+   const size_t connection = inst->sig_teardown_report.connect(
+         [&reports](const re::teardown_report &report) { reports.push_back(report); });
+   inst->reset_objects();
+   inst->sig_teardown_report.disconnect(connection);
+   ASSERT_EQ(1u, reports.size());
+   ASSERT_EQ(1u, reports[0].slow_destructors.size());
+   EXPECT_EQ(iws::reactor::index(typeid(test<93>)), reports[0].slow_destructors[0].id);
+   EXPECT_TRUE(reports[0].abandoned.empty());
+   EXPECT_FALSE(inst->instance_exists(mock_contract<test<92>>(inst)));
+
+   // The destructor of the reactor doesn't wait, test<93> goes first and takes too long, test<92> is left behind
+   reports.clear();
+   {
+      re::reactor owner;
+      populate(owner);
+      owner.set_teardown_options(options);
+      owner.sig_teardown_report.connect([&reports](const re::teardown_report &report) { reports.push_back(report); });
+   }
+   ASSERT_EQ(1u, reports.size());
+   EXPECT_EQ(std::vector<iws::reactor::index>{iws::reactor::index(typeid(test<92>))}, reports[0].abandoned);
+}
+
+namespace {
+
+template<int id>
+class logging_test : public ::reactor::test<id>
+{
+ public:
+   explicit logging_test(std::vector<int> &log)
+         : _log(log)
+   {
+   }
+   ~logging_test() { _log.push_back(id); }
+
+ private:
+   std::vector<int> &_log;
+};
+
+} // namespace
+
+TEST_F(reactor, reset_contract)
+{
+   std::vector<int> destructed;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<94>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<94>>(destructed); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<95>>>([&destructed, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<94>>(r_inst));
+            return std::make_shared<logging_test<95>>(destructed);
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<96>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<96>>(destructed); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<97>>>([&destructed, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<95>>(r_inst));
+            return std::make_shared<logging_test<97>>(destructed);
+         }));
+
+   mock_contract<test<94>> ct_94(inst);
+   mock_contract<test<96>> ct_96(inst);
+   inst->get(mock_contract<test<97>>(inst));
+   test<96> *unrelated = &inst->get(ct_96);
+   auto unrelated_handle = inst->get_handle(ct_96);
+   auto dependent_handle = inst->get_handle(mock_contract<test<95>>(inst));
+
+   // The observers hear about it like about reset_objects(), before anything is destructed
+   std::vector<int> destructed_before;
+   size_t after_signals = 0;
+   const size_t before_connection = inst->sig_before_reset_objects.connect(
+         [&destructed_before, &destructed]() { destructed_before = destructed; });
+   const size_t after_connection = inst->sig_after_reset_objects.connect([&after_signals]() { ++after_signals; });
+
+   inst->reset(ct_94);
+   EXPECT_EQ((std::vector<int>{97, 95, 94}), destructed);
+   EXPECT_TRUE(destructed_before.empty());
+   EXPECT_EQ(1u, after_signals);
+   inst->sig_before_reset_objects.disconnect(before_connection);
+   inst->sig_after_reset_objects.disconnect(after_connection);
+   EXPECT_FALSE(inst->instance_exists(ct_94));
+   EXPECT_FALSE(inst->instance_exists(mock_contract<test<97>>(inst)));
+   EXPECT_EQ(unrelated, &inst->get(ct_96));
+   EXPECT_EQ(unrelated, inst->resolve(unrelated_handle));
+   EXPECT_EQ(nullptr, inst->resolve(dependent_handle));
+   EXPECT_EQ(unrelated, inst->get_ptr(*unrelated).get());
+
+   // Rebuilt on demand, the rest of the objects are still destructed in reverse order
+   inst->get(mock_contract<test<95>>(inst));
+   destructed.clear();
+   inst->reset_objects();
+   EXPECT_EQ((std::vector<int>{95, 94, 96}), destructed);
+}
+
+TEST_F(reactor, many_objects)
+{
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<116>>>(
+               [](const std::string &) { return std::make_shared<test<116>>(); }));
+
+   // Enough objects to move the snapshot's recent additions into its shared base several times
+   std::vector<test<116> *> objects;
+   for (int i = 0; i < 1000; ++i)
+   {
+      objects.push_back(&inst->get(mock_contract<test<116>>(inst, std::to_string(i))));
+   }
+   for (int i = 0; i < 1000; ++i)
+   {
+      ASSERT_EQ(objects[i], &inst->get(mock_contract<test<116>>(inst, std::to_string(i))));
+   }
+
+   inst->reset(mock_contract<test<116>>(inst, "500"));
+   EXPECT_FALSE(inst->instance_exists(mock_contract<test<116>>(inst, "500")));
+   EXPECT_EQ(objects[999], inst->get_if_exists(mock_contract<test<116>>(inst, "999")));
+   inst->get(mock_contract<test<116>>(inst, "500"));
+   EXPECT_TRUE(inst->instance_exists(mock_contract<test<116>>(inst, "500")));
+   EXPECT_EQ(objects[0], inst->get_if_exists(mock_contract<test<116>>(inst, "0")));
+}
+
+TEST_F(reactor, reset_objects_async)
+{
+   std::vector<int> destructed;
+   std::vector<test<98> *> dependencies_seen;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<98>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<98>>(destructed); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<99>>>(
+               [&destructed, &dependencies_seen, r_inst](const std::string &) {
+                  dependencies_seen.push_back(&r_inst->get(mock_contract<test<98>>(r_inst)));
+                  return std::make_shared<logging_test<99>>(destructed);
+               }));
+
+   std::vector<std::function<void()>> tasks;
+   inst->set_async_executor([&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); });
+
+   mock_contract<test<99>> ct(inst);
+   test<99> *old = &inst->get(ct);
+   auto old_handle = inst->get_handle(ct);
+
+   std::vector<int> destructed_before;
+   test<99> *got_before = nullptr;
+   size_t after_signals = 0;
+   const size_t before_connection = inst->sig_before_reset_objects.connect(
+         [&destructed_before, &destructed, &got_before, &ct, r_inst]() {
+            destructed_before = destructed;
+            got_before = &r_inst->get(ct);
+         });
+   const size_t after_connection = inst->sig_after_reset_objects.connect([&after_signals]() { ++after_signals; });
+
+   std::shared_future<void> done = inst->reset_objects_async();
+   ASSERT_EQ(1u, tasks.size());
+   EXPECT_EQ(old, &inst->get(ct));
+   EXPECT_EQ(0u, after_signals);
+
+   tasks[0]();
+   EXPECT_EQ(1u, after_signals);
+   EXPECT_TRUE(destructed_before.empty());
+   EXPECT_EQ(&inst->get(ct), got_before);
+   inst->sig_before_reset_objects.disconnect(before_connection);
+   inst->sig_after_reset_objects.disconnect(after_connection);
+   EXPECT_EQ(std::future_status::ready, done.wait_for(std::chrono::seconds(0)));
+   EXPECT_NO_THROW(done.get());
+
+   // The new constructor got the new dependency, the old generation is gone in reverse order
+   ASSERT_EQ(2u, dependencies_seen.size());
+   EXPECT_NE(dependencies_seen[0], dependencies_seen[1]);
+   EXPECT_EQ(dependencies_seen[1], &inst->get(mock_contract<test<98>>(inst)));
+   EXPECT_EQ((std::vector<int>{99, 98}), destructed);
+   EXPECT_EQ(nullptr, inst->resolve(old_handle));
+   test<99> *current = &inst->get(ct);
+   EXPECT_EQ(current, inst->get_ptr(*current).get());
+   EXPECT_EQ(2u, inst->get_dependency_graph().nodes().size());
+
+   destructed.clear();
+   inst->reset_objects();
+   EXPECT_EQ((std::vector<int>{99, 98}), destructed);
+}
+
+TEST_F(reactor, reset_objects_async_error)
+{
+   std::atomic<int> produced(0);
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<100>>>([&produced](const std::string &) {
+            if (0 != produced++)
+            {
+               throw std::runtime_error("failed");
+            }
+            return std::make_shared<test<100>>();
+         }));
+
+   mock_contract<test<100>> ct(inst);
+   test<100> *old = &inst->get(ct);
+
+   EXPECT_THROW(inst->reset_objects_async().get(), std::runtime_error);
+   EXPECT_EQ(old, &inst->get(ct));
+}
+
+TEST_F(reactor, deferred_teardown)
+{
+   std::vector<int> destructed;
+   std::promise<void> release;
+   std::shared_future<void> released(release.get_future());
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<101>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<101>>(destructed); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<102>>>([&destructed, released](const std::string &) {
+            // Blocks the reaper until released
+            return std::shared_ptr<logging_test<102>>(
+                  new logging_test<102>(destructed), [released](logging_test<102> *obj) {
+                     released.wait();
+                     delete obj;
+                  });
+         }));
+   inst->get(mock_contract<test<101>>(inst));
+   inst->get(mock_contract<test<102>>(inst));
+
+   re::teardown_options options;
+   options.deferred = true;
+   inst->set_teardown_options(options);
+   std::atomic<int> reports(0);
+   const size_t connection =
+         inst->sig_teardown_report.connect([&reports](const re::teardown_report &) { ++reports; });
+
+   inst->reset_objects();
+   EXPECT_FALSE(inst->instance_exists(mock_contract<test<101>>(inst)));
+   EXPECT_TRUE(destructed.empty());
+
+   // The next generation is usable while the old one is still being destructed
+   EXPECT_EQ(101, inst->get(mock_contract<test<101>>(inst)).get_id());
+
+   release.set_value();
+   inst->drain();
+   EXPECT_EQ((std::vector<int>{102, 101}), destructed);
+   EXPECT_EQ(1, reports);
+   inst->sig_teardown_report.disconnect(connection);
+
+   // The destructor doesn't leave anything behind for the reaper
+   options.deferred = false;
+   inst->set_teardown_options(options);
+   inst->reset_objects();
+   EXPECT_EQ((std::vector<int>{102, 101, 101}), destructed);
+}
+
+TEST_F(reactor, checkpoint_restore)
+{
+   std::vector<int> destructed;
+   re::reactor *r_inst = inst;
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<103>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<103>>(destructed); }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<104>>>([&destructed, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<103>>(r_inst));
+            return std::make_shared<logging_test<104>>(destructed);
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<105>>>([&destructed, r_inst](const std::string &) {
+            r_inst->get(mock_contract<test<104>>(r_inst));
+            return std::make_shared<logging_test<105>>(destructed);
+         }));
+   inst->register_factory(std::string(), re::prio_normal,
+         std::make_shared<re::factory_wrapper<test<106>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<106>>(destructed); }));
+
+   mock_contract<test<103>> ct_103(inst);
+   mock_contract<test<104>> ct_104(inst);
+   mock_contract<test<105>> ct_105(inst);
+   mock_contract<test<106>> ct_106(inst);
+   inst->get(ct_105);
+   test<103> *kept = &inst->get(ct_103);
+
+   re::object_checkpoint cp = inst->checkpoint();
+   EXPECT_EQ(3u, cp.size());
+
+   // Objects created since are destructed, the rest is left alone
+   inst->get(ct_106);
+   inst->restore(cp);
+   EXPECT_EQ((std::vector<int>{106}), destructed);
+   EXPECT_FALSE(inst->instance_exists(ct_106));
+   EXPECT_EQ(kept, &inst->get(ct_103));
+
+   // An overridden factory rebuilds its object and the dependents
+   destructed.clear();
+   inst->register_factory(std::string(), re::prio_test,
+         std::make_shared<re::factory_wrapper<test<104>>>(
+               [&destructed](const std::string &) { return std::make_shared<logging_test<104>>(destructed); }));
+   inst->restore(cp);
+   EXPECT_EQ((std::vector<int>{105, 104}), destructed);
+   EXPECT_TRUE(inst->instance_exists(ct_104));
+   EXPECT_TRUE(inst->instance_exists(ct_105));
+   EXPECT_EQ(kept, &inst->get(ct_103));
+
+   // Objects destructed since are constructed again
+   destructed.clear();
+   inst->reset(ct_103);
+   EXPECT_EQ((std::vector<int>{103}), destructed);
+   inst->restore(cp);
+   EXPECT_TRUE(inst->instance_exists(ct_103));
+   EXPECT_TRUE(inst->instance_exists(ct_105));
+
+   EXPECT_THROW(inst->restore(re::object_checkpoint()), std::invalid_argument);
+
+   inst->reset_objects();
+}
+
+#ifdef REACTOR_HAS_COROUTINES
+namespace {
+
+struct detached_coroutine
+{
+   struct promise_type
+   {
+      detached_coroutine get_return_object() { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+   };
+};
+
+detached_coroutine await_test(re::reactor &r_inst, std::promise<int> &result)
+{
+   test_contract<reactor::test<81>> ct;
+   auto &obj = co_await r_inst.get_async(ct);
+   result.set_value(obj.get_id());
+}
+
+} // namespace
+
+TEST_F(reactor, get_async_co_await)
+{
+   inst->register_factory(std::string(), re::prio_normal, std::make_shared<re::factory<test<81>, test<81>, false>>());
+
+   std::promise<int> result;
+   std::future<int> id = result.get_future();
+   await_test(*inst, result);
+
+   EXPECT_EQ(std::future_status::ready, id.wait_for(std::chrono::seconds(5)));
+   EXPECT_EQ(81, id.get());
+}
+#endif
+
 TEST_F(reactor, ext_impl)
 {
    re::contract<iws::reactor_test::i_ext_test> ct;
@@ -0,0 +1,17 @@
+#ifndef __IWS_REACTOR_I_PLUGIN_TEST_HPP__
+#define __IWS_REACTOR_I_PLUGIN_TEST_HPP__
+
+namespace iws {
+namespace reactor_test {
+
+class i_plugin_test
+{
+ public:
+   virtual ~i_plugin_test() {}
+   virtual bool are_you_plugin() = 0;
+};
+
+} // namespace reactor_test
+} // namespace iws
+
+#endif // __IWS_REACTOR_I_PLUGIN_TEST_HPP__
@@ -0,0 +1,18 @@
+#include "i_plugin_test.hpp"
+
+#include <reactor/plugin_factory.hpp>
+
+namespace iws {
+namespace reactor_test {
+
+class plugin_test_impl : public i_plugin_test
+{
+ public:
+   plugin_test_impl() {}
+   virtual bool are_you_plugin() { return true; }
+};
+
+} // namespace reactor_test
+} // namespace iws
+
+REACTOR_PLUGIN_FACTORY(make_plugin_test, iws::reactor_test::i_plugin_test, iws::reactor_test::plugin_test_impl)